@@ -0,0 +1,162 @@
+#ifndef ADAPTIVEOPERATORSCHEDULER_HPP
+#define ADAPTIVEOPERATORSCHEDULER_HPP
+#include <vector>
+#include <string>
+#include <functional>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include "Population.hpp"
+#include "TerminationCondition.hpp"
+#include "RandomStream.hpp"
+
+/// @brief Chooses between variation operators by adaptive pursuit, weighting
+/// each operator by the improvement it buys per unit of cost. On every apply()
+/// one operator is drawn from the current probabilities and run; its reward is
+/// the improvement of the best-k scores (k = population size before the call)
+/// divided by either the wall time or the fitness function calls it used. The
+/// best operator's probability is pursued towards 1 - (K - 1) * minProbability,
+/// every other one towards minProbability, so no operator is ever starved.
+///
+/// Operators are wrapped as callables so any rate / extra arguments are bound
+/// by the caller, e.g.
+/// scheduler.addOperator("ox", [](Population& p, TerminationManager& t) {Variation::orderedCrossover(p, t, 1.0);});
+class AdaptiveOperatorScheduler {
+    public:
+        enum class CostMeasure {WallTime, Evaluations};
+
+        /// @brief One call of apply()
+        struct Decision {
+            int step;
+            int operatorIndex;
+            double improvement;
+            double cost;
+            double reward;
+        };
+
+        /// @param costMeasure Cost an operator's improvement is divided by
+        /// @param minProbability Lower bound on every operator's probability
+        /// @param adaptationRate Rate quality estimates follow new rewards
+        /// @param learningRate Rate probabilities are pursued towards their targets
+        AdaptiveOperatorScheduler(CostMeasure costMeasure=CostMeasure::Evaluations, double minProbability=0.05, double adaptationRate=0.3, double learningRate=0.3)
+        : costMeasure(costMeasure), minProbability(minProbability), adaptationRate(adaptationRate), learningRate(learningRate) {
+            mt.seed(RandomStream::engine()());
+        }
+
+        /// @brief Register an operator, probabilities are reset to uniform
+        /// @param name Name used in reports
+        /// @param variationOperator Callable run on the population
+        void addOperator(const std::string& name, std::function<void(Population&, TerminationManager&)> variationOperator) {
+            names.push_back(name);
+            operators.push_back(variationOperator);
+            qualities.push_back(0.0);
+            applications.push_back(0);
+            probabilities.assign(operators.size(), 1.0 / operators.size());
+            if(minProbability * operators.size() > 1.0) {
+                std::cerr << "AdaptiveOperatorScheduler::addOperator\nminProbability too large for " << operators.size() << " operators\nExiting Program\n";
+                exit(-1);
+            }
+        }
+
+        /// @brief Draw an operator, run it and update its quality / probability
+        /// @return int index of the operator that was applied
+        int apply(Population& population, TerminationManager& terminationManager) {
+            if(operators.empty()) {
+                std::cerr << "AdaptiveOperatorScheduler::apply\nNo operators have been added\nExiting Program\n";
+                exit(-1);
+            }
+            std::discrete_distribution<int> operatorDist(probabilities.begin(), probabilities.end());
+            int chosen = operatorDist(mt);
+
+            int k = population.size();
+            double scoreBefore = bestScoreSum(population, k);
+            int callsBefore = population.getObjective()->getCallCount();
+            std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+            operators[chosen](population, terminationManager);
+
+            double cost;
+            if(costMeasure == CostMeasure::WallTime) {
+                cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                cost = std::max(cost, 1e-9);
+            } else {
+                cost = std::max(1, population.getObjective()->getCallCount() - callsBefore);
+            }
+            double improvement = std::max(0.0, scoreBefore - bestScoreSum(population, k));
+            //Members rejected by the score bound score infinity, replacing one
+            //is not a measurable improvement
+            if(!std::isfinite(improvement)) improvement = 0.0;
+            double reward = improvement / cost;
+
+            applications[chosen]++;
+            qualities[chosen] += adaptationRate * (reward - qualities[chosen]);
+            pursue();
+            history.push_back(Decision{static_cast<int>(history.size()), chosen, improvement, cost, reward});
+            return chosen;
+        }
+
+        /// @brief Current probability of each operator being applied
+        const std::vector<double>& getProbabilities() const {return probabilities;}
+
+        /// @brief Current reward estimate of each operator
+        const std::vector<double>& getQualities() const {return qualities;}
+
+        /// @brief Number of times each operator has been applied
+        const std::vector<int>& getApplicationCounts() const {return applications;}
+
+        /// @brief Every decision made by apply(), in order
+        const std::vector<Decision>& getHistory() const {return history;}
+
+        const std::string& getOperatorName(int n) const {return names[n];}
+
+        int size() const {return operators.size();}
+
+        void printSummary() const {
+            for(size_t i = 0; i < operators.size(); i++) {
+                std::cout << std::setw(20) << names[i]
+                          << " p = " << std::setw(8) << probabilities[i]
+                          << " quality = " << std::setw(12) << qualities[i]
+                          << " applied = " << applications[i] << "\n";
+            }
+        }
+
+    private:
+        CostMeasure costMeasure;
+        double minProbability;
+        double adaptationRate;
+        double learningRate;
+        std::mt19937 mt;
+        std::vector<std::string> names;
+        std::vector<std::function<void(Population&, TerminationManager&)>> operators;
+        std::vector<double> probabilities;
+        std::vector<double> qualities;
+        std::vector<int> applications;
+        std::vector<Decision> history;
+        std::vector<double> scores;
+
+        /// @brief Sum of the k lowest (best) scores in the population
+        double bestScoreSum(const Population& population, int k) {
+            scores.resize(population.size());
+            for(int i = 0; i < population.size(); i++) scores[i] = population[i].getScore();
+            k = std::min(k, static_cast<int>(scores.size()));
+            if(k < static_cast<int>(scores.size())) std::nth_element(scores.begin(), scores.begin() + k, scores.end());
+            double sum = 0.0;
+            for(int i = 0; i < k; i++) sum += scores[i];
+            return sum;
+        }
+
+        void pursue() {
+            int best = std::max_element(qualities.begin(), qualities.end()) - qualities.begin();
+            //Nothing has improved yet, no operator to pursue
+            if(qualities[best] <= 0.0) return;
+            double maxProbability = 1.0 - (operators.size() - 1) * minProbability;
+            for(size_t i = 0; i < operators.size(); i++) {
+                double target = static_cast<int>(i) == best ? maxProbability : minProbability;
+                probabilities[i] += learningRate * (target - probabilities[i]);
+            }
+        }
+};
+#endif
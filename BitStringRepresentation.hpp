@@ -0,0 +1,159 @@
+#ifndef BITSTRINGREPRESENTATION_HPP
+#define BITSTRINGREPRESENTATION_HPP
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "Representation.hpp"
+#include "phenotype.hpp"
+#include "Population.hpp"
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define HAS_BUILTIN_POPCOUNT
+#endif
+
+/// @brief Binary chromosome packed 64 bits per word. Bits past size() in the
+/// last word are always zero so whole words can be compared / counted
+/// directly. getIntegerVectorRepresentation() still works but expands every
+/// bit to an int, the word-level operators in Variation avoid it
+class BitStringRepresentation : public RepresentationBase {
+    public:
+        BitStringRepresentation() {}
+
+        BitStringRepresentation(int numBits) : numBits(numBits), words(wordCount(numBits), 0) {}
+
+        BitStringRepresentation(int numBits, const std::vector<uint64_t>& words) : numBits(numBits), words(words) {
+            clearTail();
+        }
+
+        virtual std::string toString() const override {
+            std::string s(numBits, '0');
+            for(int i = 0; i < numBits; i++) {
+                if(getBit(i)) s[i] = '1';
+            }
+            return s;
+        }
+
+        virtual int size() const override {return numBits;}
+
+        virtual std::unique_ptr<RepresentationBase> emptyCopy() const override {
+            return std::make_unique<BitStringRepresentation>();
+        }
+
+        virtual std::unique_ptr<RepresentationBase> deepCopy() const override {
+            return std::make_unique<BitStringRepresentation>(*this);
+        }
+
+        /// @brief Expands the bits to a vector of 0 / 1, prefer getWords()
+        virtual std::vector<int> getIntegerVectorRepresentation() const override {
+            std::vector<int> bits(numBits);
+            for(int i = 0; i < numBits; i++) bits[i] = getBit(i);
+            return bits;
+        }
+
+        /// @brief Packs a vector of 0 / 1 (any non zero value is a set bit)
+        virtual void setIntegerVectorRepresentation(std::vector<int>& rep) override {
+            numBits = rep.size();
+            words.assign(wordCount(numBits), 0);
+            for(int i = 0; i < numBits; i++) {
+                if(rep[i]) setBit(i, true);
+            }
+        }
+
+        bool getBit(int i) const {return (words[i >> 6] >> (i & 63)) & 1ULL;}
+
+        void setBit(int i, bool value) {
+            if(value) {
+                words[i >> 6] |= 1ULL << (i & 63);
+            } else {
+                words[i >> 6] &= ~(1ULL << (i & 63));
+            }
+        }
+
+        void flipBit(int i) {words[i >> 6] ^= 1ULL << (i & 63);}
+
+        /// @brief Read only access to the packed words
+        const std::vector<uint64_t>& getWords() const {return words;}
+
+        /// @brief Replace the packed words, bits past numBits are cleared
+        void setWords(int numBits, const std::vector<uint64_t>& words) {
+            this->numBits = numBits;
+            this->words = words;
+            clearTail();
+        }
+
+        /// @brief Number of set bits
+        int popcount() const {
+            int count = 0;
+            for(uint64_t word : words) count += popcountWord(word);
+            return count;
+        }
+
+        /// @brief Number of differing bits, both strings must be the same size
+        int hammingDistance(const BitStringRepresentation& other) const {
+            int distance = 0;
+            for(size_t w = 0; w < words.size(); w++) distance += popcountWord(words[w] ^ other.words[w]);
+            return distance;
+        }
+
+        static int wordCount(int numBits) {return (numBits + 63) / 64;}
+
+        static int popcountWord(uint64_t word) {
+            #ifdef HAS_BUILTIN_POPCOUNT
+            return __builtin_popcountll(word);
+            #else
+            int count = 0;
+            while(word) {
+                word &= word - 1;
+                count++;
+            }
+            return count;
+            #endif
+        }
+
+        /// @brief Mean pairwise Hamming distance over a population of bit
+        /// strings, a cheap diversity measure. Computed from per bit column
+        /// counts in O(population size * bits) rather than comparing every pair
+        /// @param population Population whose members use BitStringRepresentation
+        /// @return double mean number of differing bits between two members
+        static double meanPairwiseHammingDistance(const Population& population) {
+            int m = population.size();
+            if(m < 2) return 0.0;
+            int numBits = population[0].getRepresentationSize();
+            std::vector<int> columnCounts(numBits, 0);
+            for(int i = 0; i < m; i++) {
+                const BitStringRepresentation* bits = dynamic_cast<const BitStringRepresentation*>(&population[i].getRepresentation());
+                if(!bits) {
+                    std::cerr << "BitStringRepresentation::meanPairwiseHammingDistance\nPopulation member is not a BitStringRepresentation\nExiting Program\n";
+                    exit(-1);
+                }
+                const std::vector<uint64_t>& memberWords = bits->getWords();
+                for(size_t w = 0; w < memberWords.size(); w++) {
+                    uint64_t word = memberWords[w];
+                    while(word) {
+                        #ifdef HAS_BUILTIN_POPCOUNT
+                        int bit = __builtin_ctzll(word);
+                        #else
+                        int bit = 0;
+                        while(!((word >> bit) & 1ULL)) bit++;
+                        #endif
+                        columnCounts[w * 64 + bit]++;
+                        word &= word - 1;
+                    }
+                }
+            }
+            double differingPairs = 0.0;
+            for(int count : columnCounts) differingPairs += static_cast<double>(count) * (m - count);
+            return differingPairs / (0.5 * static_cast<double>(m) * (m - 1));
+        }
+
+    private:
+        int numBits = 0;
+        std::vector<uint64_t> words;
+
+        void clearTail() {
+            words.resize(wordCount(numBits), 0);
+            if(numBits & 63) words.back() &= (1ULL << (numBits & 63)) - 1;
+        }
+};
+#endif
@@ -0,0 +1,117 @@
+#ifndef COMPACTPERMUTATIONREPRESENTATION_HPP
+#define COMPACTPERMUTATIONREPRESENTATION_HPP
+#include <vector>
+#include <string>
+#include <sstream>
+#include <memory>
+#include <limits>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+#include "Representation.hpp"
+
+/// @brief Permutation chromosome storing its genes as a narrow unsigned index,
+/// uint16_t for up to 65536 cities or uint32_t, halving the memory of tours
+/// held as 32 bit int genes. The built-in permutation operators detect it with
+/// visitCompactPermutation() and run their kernels, templated on the gene
+/// type, on getGenes() / getMutableGenes() directly. Other operators see the
+/// genes widened to int by getIntegerVectorRepresentation(). Use
+/// compactPermutationPrototype() or Initialisation::generateTours() without a
+/// prototype to pick the width from the chromosome size
+template <typename Index>
+class CompactPermutationRepresentation : public RepresentationBase {
+    static_assert(std::is_same<Index, uint16_t>::value || std::is_same<Index, uint32_t>::value, "CompactPermutationRepresentation<Index> supports uint16_t and uint32_t genes");
+
+    public:
+        using IndexType = Index;
+
+        CompactPermutationRepresentation() {}
+
+        CompactPermutationRepresentation(const std::vector<Index>& genes) : genes(genes) {}
+
+        virtual std::string toString() const override {
+            std::stringstream ss;
+            for(Index gene : genes) {
+                ss << gene << ",";
+            }
+            return ss.str();
+        }
+
+        virtual int size() const override {return genes.size();}
+
+        virtual std::unique_ptr<RepresentationBase> emptyCopy() const override {
+            return std::make_unique<CompactPermutationRepresentation<Index>>();
+        }
+
+        virtual std::unique_ptr<RepresentationBase> deepCopy() const override {
+            return std::make_unique<CompactPermutationRepresentation<Index>>(genes);
+        }
+
+        virtual std::vector<int> getIntegerVectorRepresentation() const override {
+            return std::vector<int>(genes.begin(), genes.end());
+        }
+
+        virtual void setIntegerVectorRepresentation(std::vector<int>& rep) override {
+            genes.resize(rep.size());
+            for(size_t i = 0; i < rep.size(); i++) {
+                if(rep[i] < 0 || static_cast<uint64_t>(rep[i]) > std::numeric_limits<Index>::max()) {
+                    std::cerr << "CompactPermutationRepresentation::setIntegerVectorRepresentation\nGene " << rep[i] << " does not fit the index type\nExiting Program\n";
+                    exit(-1);
+                }
+                genes[i] = static_cast<Index>(rep[i]);
+            }
+        }
+
+        /// @brief Read only view of the narrow genes
+        GeneView<const Index> getGenes() const {return GeneView<const Index>(genes.data(), genes.size());}
+
+        /// @brief Writable view of the narrow genes
+        GeneView<Index> getMutableGenes() {return GeneView<Index>(genes);}
+
+    protected:
+        std::vector<Index> genes;
+};
+
+/// @brief Call function with representation as the
+/// CompactPermutationRepresentation<uint16_t> or <uint32_t> it is, keeping its
+/// constness, so kernels templated on the gene type can run on the narrow genes
+/// @param function Callable taking either compact type, usually a generic lambda
+/// @return false, without calling function, for any other representation
+template <typename Representation, typename Function>
+bool visitCompactPermutation(Representation& representation, Function&& function) {
+    using Compact16 = typename std::conditional<std::is_const<Representation>::value, const CompactPermutationRepresentation<uint16_t>, CompactPermutationRepresentation<uint16_t>>::type;
+    using Compact32 = typename std::conditional<std::is_const<Representation>::value, const CompactPermutationRepresentation<uint32_t>, CompactPermutationRepresentation<uint32_t>>::type;
+    if(Compact16* compact = dynamic_cast<Compact16*>(&representation)) {
+        function(*compact);
+        return true;
+    }
+    if(Compact32* compact = dynamic_cast<Compact32*>(&representation)) {
+        function(*compact);
+        return true;
+    }
+    return false;
+}
+
+/// @brief Call function with a value of the narrowest index type able to hold
+/// every gene of a permutation of genomeLength elements, uint16_t up to
+/// 65536 elements and uint32_t beyond, e.g. to pick the Gene of a
+/// MappedPopulation
+/// @param function Callable taking uint16_t or uint32_t, usually a generic lambda
+/// @return What function returns
+template <typename Function>
+decltype(auto) withPermutationIndex(int genomeLength, Function&& function) {
+    if(genomeLength <= static_cast<int>(std::numeric_limits<uint16_t>::max()) + 1) {
+        return function(uint16_t());
+    }
+    return function(uint32_t());
+}
+
+/// @brief Empty CompactPermutationRepresentation of the narrowest index type
+/// for genomeLength genes, to use as the prototype of a population, e.g. for
+/// Initialisation::generateTours()
+std::unique_ptr<RepresentationBase> compactPermutationPrototype(int genomeLength) {
+    return withPermutationIndex(genomeLength, [](auto index) -> std::unique_ptr<RepresentationBase> {
+        return std::make_unique<CompactPermutationRepresentation<decltype(index)>>();
+    });
+}
+#endif
@@ -1,5 +1,12 @@
 #ifndef CROSSOVER_HPP
 #define CROSSOVER_HPP
+#include "RealVariationKernels.hpp"
+#include "BitStringRepresentation.hpp"
+#include "CompactPermutationRepresentation.hpp"
+#include "RandomStream.hpp"
+#include <thread>
+#include <cstdint>
+#include <type_traits>
 
 class PhenotypeBase;
 
@@ -11,14 +18,8 @@ class TerminationManager;
 
 namespace Variation {
     void simpleCrossover(Population& population, TerminationManager& terminationManager, double crossoverRate=0.8, bool verbose=false) {
-        static bool seeded = false;
-        std::default_random_engine randomEngine;
-        if(!seeded) {
-            time_t currentTime = time(NULL);
-            srand(currentTime);
-            randomEngine.seed(currentTime);
-            seeded = true;
-        }
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
         int representationSize = population[0].getRepresentationSize();
         std::vector<int> selected = population.getSelectedIndices();
         //Clear selected to use in mutation
@@ -27,23 +28,26 @@ namespace Variation {
 
 
         //Shuffle to get random pairs
-        shuffle(selected.begin(), selected.end(), randomEngine);
+        shuffle(selected.begin(), selected.end(), mt);
         for(int i = 0; i < m; i += 2) {
             if(terminationManager.checkTermination()) return;
-            double r = double(rand()) / RAND_MAX;
+            double r = realDist(mt);
             if(r > crossoverRate) continue;
-            std::vector<int> child1Permutation = std::vector<int>(representationSize);
-            std::vector<int> child2Permutation = std::vector<int>(representationSize);
             //Generate random number in range 1 - representationSize - 2 inclusive
             //First and last elements of vector must remain unchanged, i.e always
             //start and end at the same city
-            int k = rand() % (representationSize - 2) + 1;
+            int k = std::uniform_int_distribution<int>(1, representationSize - 2)(mt);
             int j;
             //Loops below will correctly set the first and last elements
             const RepresentationBase& parent1Representation = population[i].getRepresentation();
             const RepresentationBase& parent2Representation = population[i + 1].getRepresentation();
-            std::vector<int> parent1Permutation = parent1Representation.getIntegerVectorRepresentation();
-            std::vector<int> parent2Permutation = parent2Representation.getIntegerVectorRepresentation();
+            std::vector<int> parent1Scratch, parent2Scratch;
+            GeneView<const int> parent1Permutation = readIntegerGenes(parent1Representation, parent1Scratch);
+            GeneView<const int> parent2Permutation = readIntegerGenes(parent2Representation, parent2Scratch);
+            GeneWriter<int> child1Writer(parent1Representation, representationSize);
+            GeneWriter<int> child2Writer(parent2Representation, representationSize);
+            GeneView<int> child1Permutation = child1Writer.genes();
+            GeneView<int> child2Permutation = child2Writer.genes();
             for(j = 0; j <= k; j++) {
                 child1Permutation[j] = parent1Permutation[j];
                 child2Permutation[j] = parent2Permutation[j];
@@ -54,14 +58,10 @@ namespace Variation {
             }
 
             const std::unique_ptr<ObjectiveBase>& objective = population.getObjective();
-            std::unique_ptr<RepresentationBase> child1Representation = parent1Representation.emptyCopy();
-            std::unique_ptr<RepresentationBase> child2Representation = parent2Representation.emptyCopy();
-            child1Representation->setIntegerVectorRepresentation(child1Permutation);            
-            child2Representation->setIntegerVectorRepresentation(child2Permutation);            
             std::shared_ptr<PhenotypeBase> child1 = population[i].emptyCopy();
             std::shared_ptr<PhenotypeBase> child2 = population[i + 1].emptyCopy();
-            child1->setRepresentation(std::move(child1Representation), objective);
-            child2->setRepresentation(std::move(child2Representation), objective);
+            child1->setRepresentation(child1Writer.release(), objective, true);
+            child2->setRepresentation(child2Writer.release(), objective, true);
 
             //Append new phenotypes to solutions
             population.addPopulationMember(child1);
@@ -71,8 +71,99 @@ namespace Variation {
         }
 
     }
-    
-    void orderedCrossover(Population& population, TerminationManager& terminationManager, double crossoverRate=0.8, bool verbose=false) {
+
+    //Defined below, used by the numThreads paths of the crossovers
+    template <typename Kernel>
+    void parallelPermutationCrossover(Population& population, TerminationManager& terminationManager, const Kernel& kernel, double crossoverRate, int numThreads, const char* operatorName);
+
+    /// @brief Ordered crossover of one pair of permutations, same scheme as
+    /// orderedCrossover() but membership of the copied mid range is tracked
+    /// with flag vectors indexed by gene value instead of hash sets. One
+    /// instance holds the flags for one thread. Index is the gene type, int
+    /// or a narrow unsigned index such as uint16_t
+    struct OrderedCrossoverKernel {
+        std::vector<char> inMidRange1;
+        std::vector<char> inMidRange2;
+
+        template <typename Index>
+        void operator()(GeneView<const Index> parent1Permutation, GeneView<const Index> parent2Permutation, GeneView<Index> child1Permutation, GeneView<Index> child2Permutation, std::mt19937& mt) {
+            int representationSize = parent1Permutation.size();
+            std::uniform_int_distribution<int> intDist(0, representationSize - 1);
+            int a = intDist(mt);
+            int b = intDist(mt) % (representationSize - a) + a;
+            int maxGene = std::max(*std::max_element(parent1Permutation.begin(), parent1Permutation.end()), *std::max_element(parent2Permutation.begin(), parent2Permutation.end()));
+            if(static_cast<int>(inMidRange1.size()) <= maxGene) {
+                inMidRange1.assign(maxGene + 1, 0);
+                inMidRange2.assign(maxGene + 1, 0);
+            }
+            for(int m = a; m <= b; m++) {
+                inMidRange1[parent1Permutation[m]] = 1;
+                child1Permutation[m] = parent1Permutation[m];
+                inMidRange2[parent2Permutation[m]] = 1;
+                child2Permutation[m] = parent2Permutation[m];
+            }
+            int j1 = b + 1, j2 = b + 1, k = b + 1;
+            for(int i = 0; i < representationSize; i++) {
+                int fromParent2 = parent2Permutation[k % representationSize];
+                int fromParent1 = parent1Permutation[k % representationSize];
+                if(!inMidRange1[fromParent2]) {
+                    child1Permutation[j1 % representationSize] = fromParent2;
+                    j1++;
+                }
+                if(!inMidRange2[fromParent1]) {
+                    child2Permutation[j2 % representationSize] = fromParent1;
+                    j2++;
+                }
+                k++;
+            }
+            for(int m = a; m <= b; m++) {
+                inMidRange1[parent1Permutation[m]] = 0;
+                inMidRange2[parent2Permutation[m]] = 0;
+            }
+        }
+    };
+
+    /// @brief Breed one pair with kernel on the narrow genes when both parents
+    /// are the same CompactPermutationRepresentation type. The children are
+    /// deep copies of the parents overwritten by the kernel
+    /// @return false, children left unset, for any other representations
+    template <typename Kernel>
+    bool breedCompactPermutations(Kernel& kernel, const RepresentationBase& parent1, const RepresentationBase& parent2, std::unique_ptr<RepresentationBase>& child1, std::unique_ptr<RepresentationBase>& child2, std::mt19937& mt) {
+        bool bred = false;
+        visitCompactPermutation(parent1, [&](const auto& parent1Compact) {
+            using Compact = typename std::decay<decltype(parent1Compact)>::type;
+            const Compact* parent2Compact = dynamic_cast<const Compact*>(&parent2);
+            if(!parent2Compact) return;
+            std::unique_ptr<RepresentationBase> child1Copy = parent1Compact.deepCopy();
+            std::unique_ptr<RepresentationBase> child2Copy = parent2Compact->deepCopy();
+            Compact* child1Compact = dynamic_cast<Compact*>(child1Copy.get());
+            Compact* child2Compact = dynamic_cast<Compact*>(child2Copy.get());
+            if(!child1Compact || !child2Compact) return;
+            kernel(parent1Compact.getGenes(), parent2Compact->getGenes(), child1Compact->getMutableGenes(), child2Compact->getMutableGenes(), mt);
+            child1 = std::move(child1Copy);
+            child2 = std::move(child2Copy);
+            bred = true;
+        });
+        return bred;
+    }
+
+    /// @brief Ordered crossover for permutation problems
+    /// @param population Population object, pairs of selected members are bred
+    /// @param terminationManager Termination manager
+    /// @param crossoverRate Probability that a selected pair is bred
+    /// @param verbose Print parents and children, serial only
+    /// @param numThreads 1 breeds pair by pair on this thread, otherwise pairs
+    /// are bred on numThreads threads (hardware concurrency if < 1) by
+    /// parallelOrderedCrossover(). With a surrogate screen set on the
+    /// population the children of the call are screened in one batch by
+    /// Population::evaluateAndAddMembers(). Unless verbose, pairs of
+    /// CompactPermutationRepresentation parents are bred on their narrow genes
+    /// by OrderedCrossoverKernel
+    void orderedCrossover(Population& population, TerminationManager& terminationManager, double crossoverRate=0.8, bool verbose=false, int numThreads=1) {
+        if(numThreads != 1 && !verbose) {
+            parallelPermutationCrossover(population, terminationManager, OrderedCrossoverKernel(), crossoverRate, numThreads, "orderedCrossover");
+            return;
+        }
         std::vector<int> selected = population.getSelectedIndices();
         population.clearSelected();
         if(crossoverRate < 0.000001) return;
@@ -84,61 +175,294 @@ namespace Variation {
 
         int representationSize = population[0].getRepresentationSize();
         
-        static std::random_device rd;
-        static std::mt19937 mt(rd());
-        static std::uniform_int_distribution<int> intDist(0, representationSize - 1);
-        static std::uniform_real_distribution<double> realDist(0.0, 1.0);
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_int_distribution<int> intDist(0, representationSize - 1);
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
+        bool screened = population.getSurrogate() != nullptr;
+        std::vector<std::shared_ptr<PhenotypeBase>> screenedChildren;
+        //Reused between calls
+        thread_local OrderedCrossoverKernel compactKernel;
 
         for(int p = 0; p < numSelected - 1; p += 2) {
-            if(terminationManager.checkTermination()) return;
+            if(terminationManager.checkTermination()) break;
             double crossoverProbability = realDist(mt);
             if(crossoverRate < crossoverProbability) continue;
-            //Generate random number between 1 and n - 2 inclusive
-            int a = intDist(mt);
-            int b = intDist(mt) % (representationSize - a) + a;
-            int j1, j2, k;
-            j1 = b + 1; j2 = b + 1; k = b + 1;
             int p1Idx = selected[p];
             int p2Idx = selected[p + 1];
 
             const RepresentationBase& parent1Representation = population[p1Idx].getRepresentation();
             const RepresentationBase& parent2Representation = population[p2Idx].getRepresentation();
-            std::vector<int> parent1Permutation = parent1Representation.getIntegerVectorRepresentation();
-            std::vector<int> parent2Permutation = parent2Representation.getIntegerVectorRepresentation();
-
-            std::vector<int> child1Permutation = std::vector<int>(representationSize, 0);
-            std::vector<int> child2Permutation = std::vector<int>(representationSize, 0);
-            std::unordered_set<int> parent1MidRange;
-            std::unordered_set<int> parent2MidRange;
-    
-            for(int m = a; m <= b; m++) {
-                parent1MidRange.insert(parent1Permutation[m]);
-                child1Permutation[m] = parent1Permutation[m];
-                parent2MidRange.insert(parent2Permutation[m]);
-                child2Permutation[m] = parent2Permutation[m];
+            std::unique_ptr<RepresentationBase> child1Representation;
+            std::unique_ptr<RepresentationBase> child2Representation;
+
+            //Compact permutations are bred on their narrow genes by the kernel,
+            //which draws a and b as below
+            if(verbose || !breedCompactPermutations(compactKernel, parent1Representation, parent2Representation, child1Representation, child2Representation, mt)) {
+                //Generate random number between 1 and n - 2 inclusive
+                int a = intDist(mt);
+                int b = intDist(mt) % (representationSize - a) + a;
+                int j1, j2, k;
+                j1 = b + 1; j2 = b + 1; k = b + 1;
+
+                std::vector<int> parent1Scratch, parent2Scratch;
+                GeneView<const int> parent1Permutation = readIntegerGenes(parent1Representation, parent1Scratch);
+                GeneView<const int> parent2Permutation = readIntegerGenes(parent2Representation, parent2Scratch);
+
+                GeneWriter<int> child1Writer(parent1Representation, representationSize);
+                GeneWriter<int> child2Writer(parent2Representation, representationSize);
+                GeneView<int> child1Permutation = child1Writer.genes();
+                GeneView<int> child2Permutation = child2Writer.genes();
+                std::unordered_set<int> parent1MidRange;
+                std::unordered_set<int> parent2MidRange;
+
+                for(int m = a; m <= b; m++) {
+                    parent1MidRange.insert(parent1Permutation[m]);
+                    child1Permutation[m] = parent1Permutation[m];
+                    parent2MidRange.insert(parent2Permutation[m]);
+                    child2Permutation[m] = parent2Permutation[m];
+                }
+
+                for(int i = 0; i < representationSize; i++) {
+                    if(parent1MidRange.find(parent2Permutation[k % representationSize]) == parent1MidRange.end()) {
+                        child1Permutation[j1 % representationSize] = parent2Permutation[k % representationSize];
+                        j1++;
+                    }
+                    if(parent2MidRange.find(parent1Permutation[k % representationSize]) == parent2MidRange.end()) {
+                        child2Permutation[j2 % representationSize] = parent1Permutation[k % representationSize];
+                        j2++;
+                    }
+                    k++;
+                }
+                child1Representation = child1Writer.release();
+                child2Representation = child2Writer.release();
+
+                if(verbose) {
+                    std::cout << "a = " << a << ", b = " << b << "\n";
+
+                    std::cout << std::setw(10) << "indicies:";
+                    for(int i = 0; i < representationSize; i++) {
+                        std::cout << std::setw(4) << i << ",";
+                    }
+                    std::cout << "\n";
+                    std::cout << std::setw(10) << "parent1Permutation:";
+                    population[p].printRepresentation();
+                    std::cout << std::setw(10) << "parent2Permutation:";
+                    population[p + 1].printRepresentation();
+                    std::cout << std::setw(10) << "midrange1:";
+                    for(int i = 0; i < representationSize; i++) {
+                        if(i >= a && i <= b) {
+                            std::cout << std::setw(4) << parent1Permutation[i] << ",";
+                        } else {
+                            std::cout << std::setw(4) << "--" << ",";
+                        }
+                    }
+                    std::cout << "\n";
+                    std::cout << std::setw(10) << "midrange2:";
+                    for(int i = 0; i < representationSize; i++) {
+                        if(i >= a && i <= b) {
+                            std::cout << std::setw(4) << parent2Permutation[i] << ",";
+                        } else {
+                            std::cout << std::setw(4) << "--" << ",";
+                        }
+                    }
+                    std::cout << "\n";
+                    std::cout << std::setw(10) << "child1:";
+                    std::cout << *child1Representation << "\n";
+                    std::cout << std::setw(10) << "child2:";
+                    std::cout << *child2Representation << "\n";
+                }
+            }
+
+            const std::unique_ptr<ObjectiveBase>& objective = population.getObjective();
+            std::shared_ptr<PhenotypeBase> child1 = population[p1Idx].emptyCopy();
+            std::shared_ptr<PhenotypeBase> child2 = population[p2Idx].emptyCopy();
+            if(screened) {
+                child1->setRepresentation_NOEVALUATE(std::move(child1Representation));
+                child2->setRepresentation_NOEVALUATE(std::move(child2Representation));
+                screenedChildren.push_back(child1);
+                screenedChildren.push_back(child2);
+            } else {
+                child1->setRepresentation(std::move(child1Representation), objective, true);
+                child2->setRepresentation(std::move(child2Representation), objective, true);
+
+                population.addPopulationMember(child1);
+                population.select(population.size() - 1);
+                population.addPopulationMember(child2);
+                population.select(population.size() - 1);
             }
+        }
+        if(!screenedChildren.empty()) population.evaluateAndAddMembers(screenedChildren, true);
+    }
+
+    /// @brief Edge recombination of one pair of permutations of 0..n-1. Holds
+    /// its adjacency buffers (4 neighbour slots per city, flat arrays) so one
+    /// instance can be reused for every pair bred on a thread
+    struct EdgeRecombinationKernel {
+        std::vector<int> adjacency;
+        std::vector<char> common;
+        std::vector<int> degree;
+        std::vector<int> unvisited;
+        std::vector<int> unvisitedIndex;
+
+        /// @brief Breed two children, each keeps the starting city of one parent.
+        /// Children must be the same size as the parents. Index is the gene
+        /// type, int or a narrow unsigned index such as uint16_t
+        template <typename Index>
+        void operator()(GeneView<const Index> parent1Permutation, GeneView<const Index> parent2Permutation, GeneView<Index> child1Permutation, GeneView<Index> child2Permutation, std::mt19937& mt) {
+            buildChild(parent1Permutation, parent2Permutation, parent1Permutation[0], child1Permutation, mt);
+            buildChild(parent1Permutation, parent2Permutation, parent2Permutation[0], child2Permutation, mt);
+        }
+
+        template <typename Index>
+        void buildChild(GeneView<const Index> parent1Permutation, GeneView<const Index> parent2Permutation, int start, GeneView<Index> child, std::mt19937& mt) {
+            int representationSize = parent1Permutation.size();
+            adjacency.resize(4 * representationSize);
+            common.resize(4 * representationSize);
+            degree.assign(representationSize, 0);
+            unvisited.resize(representationSize);
+            unvisitedIndex.resize(representationSize);
+            std::uniform_real_distribution<double> realDist(0.0, 1.0);
 
             for(int i = 0; i < representationSize; i++) {
-                if(parent1MidRange.find(parent2Permutation[k % representationSize]) == parent1MidRange.end()) {
-                    child1Permutation[j1 % representationSize] = parent2Permutation[k % representationSize];
-                    j1++;
+                int next = (i + 1) % representationSize;
+                addEdge(parent1Permutation[i], parent1Permutation[next]);
+                addEdge(parent1Permutation[next], parent1Permutation[i]);
+            }
+            for(int i = 0; i < representationSize; i++) {
+                int next = (i + 1) % representationSize;
+                addEdge(parent2Permutation[i], parent2Permutation[next]);
+                addEdge(parent2Permutation[next], parent2Permutation[i]);
+            }
+            std::iota(unvisited.begin(), unvisited.end(), 0);
+            std::iota(unvisitedIndex.begin(), unvisitedIndex.end(), 0);
+            int numUnvisited = representationSize;
+
+            int current = start;
+            for(int i = 0; i < representationSize; i++) {
+                child[i] = current;
+                //Swap remove current from unvisited
+                int last = unvisited[numUnvisited - 1];
+                unvisited[unvisitedIndex[current]] = last;
+                unvisitedIndex[last] = unvisitedIndex[current];
+                numUnvisited--;
+                for(int k = 0; k < degree[current]; k++) {
+                    removeEdge(adjacency[4 * current + k], current);
                 }
-                if(parent2MidRange.find(parent1Permutation[k % representationSize]) == parent2MidRange.end()) {
-                    child2Permutation[j2 % representationSize] = parent1Permutation[k % representationSize];
-                    j2++;
+                if(numUnvisited == 0) break;
+
+                int next = -1;
+                int bestDegree = 5;
+                int ties = 0;
+                for(int k = 0; k < degree[current]; k++) {
+                    int candidate = adjacency[4 * current + k];
+                    if(common[4 * current + k]) {
+                        next = candidate;
+                        break;
+                    }
+                    if(degree[candidate] < bestDegree) {
+                        bestDegree = degree[candidate];
+                        next = candidate;
+                        ties = 1;
+                    } else if(degree[candidate] == bestDegree) {
+                        //Reservoir sample between equally good neighbours
+                        ties++;
+                        if(realDist(mt) * ties < 1.0) next = candidate;
+                    }
                 }
-                k++;
+                if(next == -1) {
+                    std::uniform_int_distribution<int> unvisitedDist(0, numUnvisited - 1);
+                    next = unvisited[unvisitedDist(mt)];
+                }
+                current = next;
+            }
+        }
+
+        void addEdge(int from, int to) {
+            for(int k = 0; k < degree[from]; k++) {
+                if(adjacency[4 * from + k] == to) {
+                    common[4 * from + k] = 1;
+                    return;
+                }
+            }
+            adjacency[4 * from + degree[from]] = to;
+            common[4 * from + degree[from]] = 0;
+            degree[from]++;
+        }
+
+        void removeEdge(int from, int to) {
+            for(int k = 0; k < degree[from]; k++) {
+                if(adjacency[4 * from + k] == to) {
+                    degree[from]--;
+                    adjacency[4 * from + k] = adjacency[4 * from + degree[from]];
+                    common[4 * from + k] = common[4 * from + degree[from]];
+                    return;
+                }
+            }
+        }
+    };
+
+    /// @brief Edge recombination crossover for permutation problems. Children
+    /// are built from the union of both parents' tour edges, preferring edges
+    /// common to both parents, then the neighbour with the fewest remaining
+    /// edges. The kernel's buffers are reused between calls.
+    /// CompactPermutationRepresentation parents are bred on their narrow genes.
+    /// @param population Population object, pairs of selected members are bred
+    /// @param terminationManager Termination manager
+    /// @param crossoverRate Probability that a selected pair is bred
+    /// @param verbose Print parents and children, serial only
+    /// @param numThreads 1 breeds pair by pair on this thread, otherwise pairs
+    /// are bred on numThreads threads (hardware concurrency if < 1) by
+    /// parallelEdgeRecombinationCrossover()
+    void edgeRecombinationCrossover(Population& population, TerminationManager& terminationManager, double crossoverRate=0.8, bool verbose=false, int numThreads=1) {
+        if(numThreads != 1 && !verbose) {
+            parallelPermutationCrossover(population, terminationManager, EdgeRecombinationKernel(), crossoverRate, numThreads, "edgeRecombinationCrossover");
+            return;
+        }
+        std::vector<int> selected = population.getSelectedIndices();
+        population.clearSelected();
+        if(crossoverRate < 0.000001) return;
+        int numSelected = selected.size();
+        if(numSelected < 2) {
+            std::cerr << "Variation::edgeRecombinationCrossover\nCan't have n < 2 for edge recombination crossover\nExiting Program\n";
+            exit(-1);
+        }
+
+        int representationSize = population[0].getRepresentationSize();
+
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
+
+        //Reused between calls
+        thread_local EdgeRecombinationKernel kernel;
+        std::vector<int> parent1Scratch, parent2Scratch;
+
+        for(int p = 0; p < numSelected - 1; p += 2) {
+            if(terminationManager.checkTermination()) return;
+            double crossoverProbability = realDist(mt);
+            if(crossoverRate < crossoverProbability) continue;
+            int p1Idx = selected[p];
+            int p2Idx = selected[p + 1];
+
+            const RepresentationBase& parent1Representation = population[p1Idx].getRepresentation();
+            const RepresentationBase& parent2Representation = population[p2Idx].getRepresentation();
+            std::unique_ptr<RepresentationBase> child1Representation;
+            std::unique_ptr<RepresentationBase> child2Representation;
+            //Compact permutations are bred on their narrow genes
+            if(!breedCompactPermutations(kernel, parent1Representation, parent2Representation, child1Representation, child2Representation, mt)) {
+                GeneView<const int> parent1Permutation = readIntegerGenes(parent1Representation, parent1Scratch);
+                GeneView<const int> parent2Permutation = readIntegerGenes(parent2Representation, parent2Scratch);
+                GeneWriter<int> child1Writer(parent1Representation, representationSize);
+                GeneWriter<int> child2Writer(parent2Representation, representationSize);
+                kernel(parent1Permutation, parent2Permutation, child1Writer.genes(), child2Writer.genes(), mt);
+                child1Representation = child1Writer.release();
+                child2Representation = child2Writer.release();
             }
 
             const std::unique_ptr<ObjectiveBase>& objective = population.getObjective();
-            std::unique_ptr<RepresentationBase> child1Representation = parent1Representation.emptyCopy();
-            std::unique_ptr<RepresentationBase> child2Representation = parent2Representation.emptyCopy();
-            child1Representation->setIntegerVectorRepresentation(child1Permutation);            
-            child2Representation->setIntegerVectorRepresentation(child2Permutation);            
             std::shared_ptr<PhenotypeBase> child1 = population[p1Idx].emptyCopy();
             std::shared_ptr<PhenotypeBase> child2 = population[p2Idx].emptyCopy();
-            child1->setRepresentation(std::move(child1Representation), objective);
-            child2->setRepresentation(std::move(child2Representation), objective);
+            child1->setRepresentation(std::move(child1Representation), objective, true);
+            child2->setRepresentation(std::move(child2Representation), objective, true);
 
             population.addPopulationMember(child1);
             population.select(population.size() - 1);
@@ -146,42 +470,402 @@ namespace Variation {
             population.select(population.size() - 1);
 
             if(verbose) {
-                std::cout << "a = " << a << ", b = " << b << "\n";
-
-                std::cout << std::setw(10) << "indicies:";
-                for(int i = 0; i < representationSize; i++) {
-                    std::cout << std::setw(4) << i << ",";
-                }
-                std::cout << "\n";
                 std::cout << std::setw(10) << "parent1Permutation:";
-                population[p].printRepresentation();
+                population[p1Idx].printRepresentation();
                 std::cout << std::setw(10) << "parent2Permutation:";
-                population[p + 1].printRepresentation();
-                std::cout << std::setw(10) << "midrange1:";
-                for(int i = 0; i < representationSize; i++) {
-                    if(i >= a && i <= b) {
-                        std::cout << std::setw(4) << parent1Permutation[i] << ",";
-                    } else {
-                        std::cout << std::setw(4) << "--" << ",";
-                    }
-                }
-                std::cout << "\n";
-                std::cout << std::setw(10) << "midrange2:";
-                for(int i = 0; i < representationSize; i++) {
-                    if(i >= a && i <= b) {
-                        std::cout << std::setw(4) << parent2Permutation[i] << ",";
-                    } else {
-                        std::cout << std::setw(4) << "--" << ",";
-                    }
-                }
-                std::cout << "\n";
+                population[p2Idx].printRepresentation();
                 std::cout << std::setw(10) << "child1:";
                 child1->printRepresentation();
                 std::cout << std::setw(10) << "child2:";
                 child2->printRepresentation();
             }
+        }
+    }
 
+    /// @brief Simulated binary crossover for real-valued representations. All
+    /// bred pairs are gathered into contiguous parent matrices, crossed in one
+    /// batch kernel, bounded and then scattered back into new population members
+    /// @param population Population object, pairs of selected members are bred
+    /// @param terminationManager Termination manager
+    /// @param lowerBounds Per gene lower bound
+    /// @param upperBounds Per gene upper bound
+    /// @param crossoverRate Probability that a selected pair is bred
+    /// @param distributionIndex SBX distribution index, larger keeps children
+    /// closer to their parents
+    /// @param boundHandling How out of bounds genes are repaired
+    /// @param geneCrossoverRate Probability that each gene of a bred pair is
+    /// crossed, the rest are copied from the parents, 0.5 as in standard SBX
+    void simulatedBinaryCrossover(Population& population, TerminationManager& terminationManager, const std::vector<double>& lowerBounds, const std::vector<double>& upperBounds, double crossoverRate=0.8, double distributionIndex=15.0, Kernels::BoundHandling boundHandling=Kernels::BoundHandling::Clamp, double geneCrossoverRate=0.5) {
+        std::vector<int> selected = population.getSelectedIndices();
+        population.clearSelected();
+        if(crossoverRate < 0.000001) return;
+        int numSelected = selected.size();
+        if(numSelected < 2) {
+            std::cerr << "Variation::simulatedBinaryCrossover\nCan't have n < 2 for simulated binary crossover\nExiting Program\n";
+            exit(-1);
         }
+        int dimensions = population[0].getRepresentationSize();
+        if(static_cast<int>(lowerBounds.size()) != dimensions || static_cast<int>(upperBounds.size()) != dimensions) {
+            std::cerr << "Variation::simulatedBinaryCrossover\nBounds must have one entry per gene\nExiting Program\n";
+            exit(-1);
+        }
+
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
+
+        std::vector<int> bredPairs;
+        for(int p = 0; p < numSelected - 1; p += 2) {
+            if(realDist(mt) <= crossoverRate) bredPairs.push_back(p);
+        }
+        int numPairs = bredPairs.size();
+        if(numPairs == 0) return;
+
+        //Reused between calls
+        thread_local std::vector<double> parents1, parents2, draws, mask, children1, children2;
+        size_t matrixSize = static_cast<size_t>(numPairs) * dimensions;
+        parents1.resize(matrixSize);
+        parents2.resize(matrixSize);
+        draws.resize(matrixSize);
+        mask.resize(matrixSize);
+        children1.resize(matrixSize);
+        children2.resize(matrixSize);
+
+        std::vector<double> parent1Scratch, parent2Scratch;
+        for(int k = 0; k < numPairs; k++) {
+            GeneView<const double> parent1Genes = readDoubleGenes(population[selected[bredPairs[k]]].getRepresentation(), parent1Scratch);
+            GeneView<const double> parent2Genes = readDoubleGenes(population[selected[bredPairs[k] + 1]].getRepresentation(), parent2Scratch);
+            std::copy(parent1Genes.begin(), parent1Genes.end(), parents1.begin() + static_cast<size_t>(k) * dimensions);
+            std::copy(parent2Genes.begin(), parent2Genes.end(), parents2.begin() + static_cast<size_t>(k) * dimensions);
+        }
+
+        Kernels::fillUniform(draws.data(), matrixSize, mt);
+        Kernels::fillUniform(mask.data(), matrixSize, mt);
+        Kernels::simulatedBinaryCrossover(parents1.data(), parents2.data(), draws.data(), mask.data(), children1.data(), children2.data(), matrixSize, distributionIndex, geneCrossoverRate);
+        Kernels::applyBounds(children1.data(), lowerBounds.data(), upperBounds.data(), numPairs, dimensions, boundHandling);
+        Kernels::applyBounds(children2.data(), lowerBounds.data(), upperBounds.data(), numPairs, dimensions, boundHandling);
+
+        const std::unique_ptr<ObjectiveBase>& objective = population.getObjective();
+        for(int k = 0; k < numPairs; k++) {
+            if(terminationManager.checkTermination()) return;
+            int p1Idx = selected[bredPairs[k]];
+            int p2Idx = selected[bredPairs[k] + 1];
+            GeneWriter<double> child1Writer(population[p1Idx].getRepresentation(), dimensions);
+            GeneWriter<double> child2Writer(population[p2Idx].getRepresentation(), dimensions);
+            std::copy(children1.begin() + static_cast<size_t>(k) * dimensions, children1.begin() + static_cast<size_t>(k + 1) * dimensions, child1Writer.genes().begin());
+            std::copy(children2.begin() + static_cast<size_t>(k) * dimensions, children2.begin() + static_cast<size_t>(k + 1) * dimensions, child2Writer.genes().begin());
+            std::shared_ptr<PhenotypeBase> child1 = population[p1Idx].emptyCopy();
+            std::shared_ptr<PhenotypeBase> child2 = population[p2Idx].emptyCopy();
+            child1->setRepresentation(child1Writer.release(), objective, true);
+            child2->setRepresentation(child2Writer.release(), objective, true);
+
+            population.addPopulationMember(child1);
+            population.select(population.size() - 1);
+            population.addPopulationMember(child2);
+            population.select(population.size() - 1);
+        }
+    }
+
+    /// @brief Shared driver for the bit string crossovers. Each bred pair gets
+    /// a crossover mask, children are then mixed a whole word at a time:
+    /// child1 = (parent1 & mask) | (parent2 & ~mask) and child2 the complement
+    /// @param fillMask Callable (std::vector<uint64_t>& mask, int numBits, std::mt19937_64& mt)
+    template <typename MaskFill>
+    void bitStringCrossover(Population& population, TerminationManager& terminationManager, double crossoverRate, const char* operatorName, MaskFill fillMask) {
+        std::vector<int> selected = population.getSelectedIndices();
+        population.clearSelected();
+        if(crossoverRate < 0.000001) return;
+        int numSelected = selected.size();
+        if(numSelected < 2) {
+            std::cerr << "Variation::" << operatorName << "\nCan't have n < 2 for crossover\nExiting Program\n";
+            exit(-1);
+        }
+
+        std::mt19937_64& mt = RandomStream::engine64();
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
+
+        std::vector<uint64_t> mask;
+        std::vector<uint64_t> child1Words;
+        std::vector<uint64_t> child2Words;
+
+        for(int p = 0; p < numSelected - 1; p += 2) {
+            if(terminationManager.checkTermination()) return;
+            double crossoverProbability = realDist(mt);
+            if(crossoverRate < crossoverProbability) continue;
+            int p1Idx = selected[p];
+            int p2Idx = selected[p + 1];
+
+            const BitStringRepresentation* parent1Bits = dynamic_cast<const BitStringRepresentation*>(&population[p1Idx].getRepresentation());
+            const BitStringRepresentation* parent2Bits = dynamic_cast<const BitStringRepresentation*>(&population[p2Idx].getRepresentation());
+            if(!parent1Bits || !parent2Bits) {
+                std::cerr << "Variation::" << operatorName << "\nPopulation members must use BitStringRepresentation\nExiting Program\n";
+                exit(-1);
+            }
+            if(parent1Bits->size() != parent2Bits->size()) {
+                std::cerr << "Variation::" << operatorName << "\nParents must have the same number of bits, got " << parent1Bits->size() << " and " << parent2Bits->size() << "\nExiting Program\n";
+                exit(-1);
+            }
+            int numBits = parent1Bits->size();
+            const std::vector<uint64_t>& parent1Words = parent1Bits->getWords();
+            const std::vector<uint64_t>& parent2Words = parent2Bits->getWords();
+            int numWords = parent1Words.size();
+
+            mask.assign(numWords, 0);
+            fillMask(mask, numBits, mt);
+            child1Words.resize(numWords);
+            child2Words.resize(numWords);
+            for(int w = 0; w < numWords; w++) {
+                child1Words[w] = (parent1Words[w] & mask[w]) | (parent2Words[w] & ~mask[w]);
+                child2Words[w] = (parent2Words[w] & mask[w]) | (parent1Words[w] & ~mask[w]);
+            }
+
+            const std::unique_ptr<ObjectiveBase>& objective = population.getObjective();
+            std::unique_ptr<RepresentationBase> child1Representation = parent1Bits->emptyCopy();
+            std::unique_ptr<RepresentationBase> child2Representation = parent2Bits->emptyCopy();
+            static_cast<BitStringRepresentation*>(child1Representation.get())->setWords(numBits, child1Words);
+            static_cast<BitStringRepresentation*>(child2Representation.get())->setWords(numBits, child2Words);
+            std::shared_ptr<PhenotypeBase> child1 = population[p1Idx].emptyCopy();
+            std::shared_ptr<PhenotypeBase> child2 = population[p2Idx].emptyCopy();
+            child1->setRepresentation(std::move(child1Representation), objective, true);
+            child2->setRepresentation(std::move(child2Representation), objective, true);
+
+            population.addPopulationMember(child1);
+            population.select(population.size() - 1);
+            population.addPopulationMember(child2);
+            population.select(population.size() - 1);
+        }
+    }
+
+    /// @brief Sets mask bits [first, last) to one
+    void setBitRange(std::vector<uint64_t>& mask, int first, int last) {
+        for(int w = first >> 6; w < static_cast<int>(mask.size()) && w * 64 < last; w++) {
+            int lo = std::max(first - w * 64, 0);
+            int hi = std::min(last - w * 64, 64);
+            uint64_t upper = hi == 64 ? ~0ULL : (1ULL << hi) - 1;
+            uint64_t lower = (1ULL << lo) - 1;
+            mask[w] |= upper & ~lower;
+        }
+    }
+
+    /// @brief Uniform crossover for BitStringRepresentation, each bit comes
+    /// from either parent with equal probability using one random word per 64 bits
+    void uniformBitCrossover(Population& population, TerminationManager& terminationManager, double crossoverRate=0.8) {
+        bitStringCrossover(population, terminationManager, crossoverRate, "uniformBitCrossover",
+            [](std::vector<uint64_t>& mask, int, std::mt19937_64& mt) {
+                for(uint64_t& word : mask) word = mt();
+            });
+    }
+
+    /// @brief One point crossover for BitStringRepresentation
+    void onePointBitCrossover(Population& population, TerminationManager& terminationManager, double crossoverRate=0.8) {
+        bitStringCrossover(population, terminationManager, crossoverRate, "onePointBitCrossover",
+            [](std::vector<uint64_t>& mask, int numBits, std::mt19937_64& mt) {
+                std::uniform_int_distribution<int> pointDist(1, std::max(1, numBits - 1));
+                setBitRange(mask, 0, pointDist(mt));
+            });
+    }
+
+    /// @brief Two point crossover for BitStringRepresentation, bits between
+    /// the two points come from the other parent
+    void twoPointBitCrossover(Population& population, TerminationManager& terminationManager, double crossoverRate=0.8) {
+        bitStringCrossover(population, terminationManager, crossoverRate, "twoPointBitCrossover",
+            [](std::vector<uint64_t>& mask, int numBits, std::mt19937_64& mt) {
+                std::uniform_int_distribution<int> pointDist(0, numBits);
+                int a = pointDist(mt);
+                int b = pointDist(mt);
+                if(a > b) std::swap(a, b);
+                setBitRange(mask, 0, a);
+                setBitRange(mask, b, numBits);
+            });
+    }
+
+    /// @brief Seed and call counter shared by the parallel breeding functions
+    /// called from one thread, kept with the thread's engines
+    using ParallelBreedingState = RandomStream::BreedingState;
+
+    ParallelBreedingState& parallelBreedingState() {
+        return RandomStream::breedingState();
+    }
+
+    /// @brief Fix the seed of the parallel breeding functions called from this
+    /// thread, children then depend only on the seed, how many parallel
+    /// breeding calls came before and the index of the pair, never on the
+    /// number of threads. RandomStream::seed() sets it too
+    void setParallelBreedingSeed(uint64_t seed) {
+        parallelBreedingState().seed = seed;
+        parallelBreedingState().calls = 0;
+    }
+
+    /// @brief Genes of a parent bred by parallelPermutationCrossover(), int
+    /// genes are read through scratch if the representation has no view
+    GeneView<const int> readPermutationGenes(const RepresentationBase& representation, std::vector<int>& scratch) {
+        return readIntegerGenes(representation, scratch);
+    }
+
+    /// @brief Narrow genes of a parent known to be a CompactPermutationRepresentation<Index>
+    template <typename Index>
+    GeneView<const Index> readPermutationGenes(const RepresentationBase& representation, std::vector<Index>&) {
+        return static_cast<const CompactPermutationRepresentation<Index>&>(representation).getGenes();
+    }
+
+    /// @brief Child representation of parent's type holding genes
+    std::unique_ptr<RepresentationBase> permutationChild(const RepresentationBase& parent, GeneView<const int> genes) {
+        GeneWriter<int> childWriter(parent, genes.size());
+        std::copy(genes.begin(), genes.end(), childWriter.genes().begin());
+        return childWriter.release();
+    }
+
+    /// @brief Child CompactPermutationRepresentation<Index> holding genes, a
+    /// deep copy of parent overwritten in place
+    template <typename Index>
+    std::unique_ptr<RepresentationBase> permutationChild(const RepresentationBase& parent, GeneView<const Index> genes) {
+        std::unique_ptr<RepresentationBase> child = parent.deepCopy();
+        CompactPermutationRepresentation<Index>* compact = dynamic_cast<CompactPermutationRepresentation<Index>*>(child.get());
+        if(compact && compact->size() == static_cast<int>(genes.size())) {
+            std::copy(genes.begin(), genes.end(), compact->getMutableGenes().begin());
+            return child;
+        }
+        //Subclasses whose deepCopy() is of another type are written widened
+        GeneWriter<int> childWriter(parent, genes.size());
+        std::copy(genes.begin(), genes.end(), childWriter.genes().begin());
+        return childWriter.release();
+    }
+
+    /// @brief Body of parallelPermutationCrossover() for genes of type Gene,
+    /// int or the Index of the parents' CompactPermutationRepresentation
+    /// @return Unevaluated children in pair order
+    template <typename Gene, typename Kernel>
+    std::vector<std::shared_ptr<PhenotypeBase>> breedPermutationPairs(Population& population, const std::vector<int>& selected, const Kernel& kernel, double crossoverRate, int numThreads, uint64_t seed, uint64_t call) {
+        int numPairs = selected.size() / 2;
+
+        //Take a view of each distinct parent once on this thread,
+        //representations may cache lazily and are not safe to read concurrently.
+        //Parents without views are copied into scratch
+        std::vector<int> parentSlot(population.size(), -1);
+        std::vector<GeneView<const Gene>> parentPermutations;
+        std::vector<std::vector<Gene>> parentScratch;
+        parentScratch.reserve(selected.size());
+        for(int sel : selected) {
+            if(parentSlot[sel] != -1) continue;
+            parentSlot[sel] = parentPermutations.size();
+            parentScratch.emplace_back();
+            parentPermutations.push_back(readPermutationGenes(population[sel].getRepresentation(), parentScratch.back()));
+        }
+
+        //Children of each thread are stored back to back in one flat buffer
+        struct ChildBuffer {
+            std::vector<int> parentIndices;
+            std::vector<size_t> offsets;
+            std::vector<Gene> genes;
+        };
+        if(numThreads < 1) numThreads = std::max(1u, std::thread::hardware_concurrency());
+        numThreads = std::min(numThreads, numPairs);
+        std::vector<ChildBuffer> buffers(numThreads);
+
+        auto breedSlice = [&](int t) {
+            Kernel localKernel = kernel;
+            ChildBuffer& buffer = buffers[t];
+            std::mt19937 mt;
+            std::uniform_real_distribution<double> realDist(0.0, 1.0);
+            for(int pair = t * numPairs / numThreads; pair < (t + 1) * numPairs / numThreads; pair++) {
+                std::seed_seq seedSequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), static_cast<uint32_t>(call), static_cast<uint32_t>(call >> 32), static_cast<uint32_t>(pair)};
+                mt.seed(seedSequence);
+                if(crossoverRate < realDist(mt)) continue;
+                int p1Idx = selected[2 * pair];
+                int p2Idx = selected[2 * pair + 1];
+                GeneView<const Gene> parent1Permutation = parentPermutations[parentSlot[p1Idx]];
+                GeneView<const Gene> parent2Permutation = parentPermutations[parentSlot[p2Idx]];
+                size_t offset = buffer.genes.size();
+                size_t childSize = parent1Permutation.size();
+                buffer.genes.resize(offset + 2 * childSize);
+                GeneView<Gene> child1Permutation(buffer.genes.data() + offset, childSize);
+                GeneView<Gene> child2Permutation(buffer.genes.data() + offset + childSize, childSize);
+                localKernel(parent1Permutation, parent2Permutation, child1Permutation, child2Permutation, mt);
+                buffer.parentIndices.push_back(p1Idx);
+                buffer.offsets.push_back(offset);
+                buffer.parentIndices.push_back(p2Idx);
+                buffer.offsets.push_back(offset + childSize);
+            }
+        };
+
+        if(numThreads == 1) {
+            breedSlice(0);
+        } else {
+            std::vector<std::thread> threads;
+            for(int t = 0; t < numThreads; t++) threads.emplace_back(breedSlice, t);
+            for(std::thread& thread : threads) thread.join();
+        }
+
+        //Merge in pair order
+        std::vector<std::shared_ptr<PhenotypeBase>> children;
+        for(ChildBuffer& buffer : buffers) {
+            for(size_t c = 0; c < buffer.offsets.size(); c++) {
+                int parentIdx = buffer.parentIndices[c];
+                size_t end = c + 1 < buffer.offsets.size() ? buffer.offsets[c + 1] : buffer.genes.size();
+                GeneView<const Gene> genes(buffer.genes.data() + buffer.offsets[c], end - buffer.offsets[c]);
+                std::shared_ptr<PhenotypeBase> child = population[parentIdx].emptyCopy();
+                child->setRepresentation_NOEVALUATE(permutationChild(population[parentIdx].getRepresentation(), genes));
+                children.push_back(child);
+            }
+        }
+        return children;
+    }
+
+    /// @brief Breeds the selected pairs on several threads. Parents are read
+    /// once up front, then each thread takes a contiguous slice of pairs and
+    /// writes children into its own buffer using its own copy of kernel. Every
+    /// pair draws from an engine seeded by (seed, call, pair index). When every
+    /// selected parent is the same CompactPermutationRepresentation type and
+    /// kernel accepts its genes, parents, buffers and children keep the narrow
+    /// genes. The buffers are merged in pair order and handed to
+    /// Population::evaluateAndAddMembers(), which applies any surrogate screen,
+    /// evaluates with one ObjectiveBase::evaluateBatch() call (parallel for
+    /// thread safe or out of process objectives) and appends in one pass. The
+    /// termination check is made once per call, so a FitnessFunctionCall limit
+    /// can be exceeded by up to one batch
+    /// @param kernel Callable (GeneView<const Gene> parent1, GeneView<const Gene>
+    /// parent2, GeneView<Gene> child1, GeneView<Gene> child2, std::mt19937&)
+    /// for Gene int and, to breed compact permutations narrow, their index type
+    /// @param numThreads Worker threads, defaults to hardware concurrency
+    template <typename Kernel>
+    void parallelPermutationCrossover(Population& population, TerminationManager& terminationManager, const Kernel& kernel, double crossoverRate, int numThreads, const char* operatorName) {
+        std::vector<int> selected = population.getSelectedIndices();
+        population.clearSelected();
+        if(crossoverRate < 0.000001) return;
+        int numSelected = selected.size();
+        if(numSelected < 2) {
+            std::cerr << "Variation::" << operatorName << "\nCan't have n < 2 for crossover\nExiting Program\n";
+            exit(-1);
+        }
+        if(terminationManager.checkTermination()) return;
+
+        ParallelBreedingState& state = parallelBreedingState();
+        uint64_t call = state.calls++;
+
+        std::vector<std::shared_ptr<PhenotypeBase>> children;
+        bool compact = false;
+        visitCompactPermutation(population[selected[0]].getRepresentation(), [&](const auto& first) {
+            using Compact = typename std::decay<decltype(first)>::type;
+            using Index = typename Compact::IndexType;
+            if constexpr (std::is_invocable<Kernel&, GeneView<const Index>, GeneView<const Index>, GeneView<Index>, GeneView<Index>, std::mt19937&>::value) {
+                for(int sel : selected) {
+                    if(!dynamic_cast<const Compact*>(&population[sel].getRepresentation())) return;
+                }
+                children = breedPermutationPairs<Index>(population, selected, kernel, crossoverRate, numThreads, state.seed, call);
+                compact = true;
+            }
+        });
+        if(!compact) children = breedPermutationPairs<int>(population, selected, kernel, crossoverRate, numThreads, state.seed, call);
+        population.evaluateAndAddMembers(children, true);
+    }
+
+    /// @brief Parallel, seed deterministic version of orderedCrossover()
+    void parallelOrderedCrossover(Population& population, TerminationManager& terminationManager, double crossoverRate=0.8, int numThreads=-1) {
+        parallelPermutationCrossover(population, terminationManager, OrderedCrossoverKernel(), crossoverRate, numThreads, "parallelOrderedCrossover");
+    }
+
+    /// @brief Parallel, seed deterministic version of edgeRecombinationCrossover()
+    void parallelEdgeRecombinationCrossover(Population& population, TerminationManager& terminationManager, double crossoverRate=0.8, int numThreads=-1) {
+        parallelPermutationCrossover(population, terminationManager, EdgeRecombinationKernel(), crossoverRate, numThreads, "parallelEdgeRecombinationCrossover");
     }
 }
 #endif
\ No newline at end of file
@@ -7,10 +7,11 @@
 #include "Population.hpp"
 #include "Objective.hpp"
 #include "phenotype.hpp"
+#include "StagnationMonitor.hpp"
 
 class GeneticAlgorithm {
     public:
-        ~GeneticAlgorithm() {}
+        virtual ~GeneticAlgorithm() {}
         GeneticAlgorithm(std::shared_ptr<PhenotypeBase> emptyPhenotype, std::vector<std::unique_ptr<RepresentationBase>> representations, std::unique_ptr<ObjectiveBase> objective) 
         : objective(std::move(objective)) {
             this->population = std::make_unique<Population>(emptyPhenotype, std::move(representations), this->objective);
@@ -18,21 +19,38 @@ class GeneticAlgorithm {
 
         virtual void run() final {
             setup();
-            std::shared_ptr<PhenotypeBase> best = population->getPopulationMember(0).deepCopy();
             while(!terminationManager.checkTermination()) {
-                geneticAlgorithm();
-                population->sort();
-                if(population->getPopulationMember(0) < *best) {
-                    best = population->getPopulationMember(0).deepCopy();
-                }
+                generation();
                 if(terminationManager.reportProgress()) {
-                    std::cout << "Current best score: " << best->getScore() << "\n";
+                    std::cout << "Current best score: " << bestScore << "\n";
+                    if(stagnationMonitor) stagnationMonitor->printSummary();
                 }
             }
-            std::cout << "Best solution score: " << best->getScore() << "\n";
+            std::cout << "Best solution score: " << bestScore << "\n";
+            if(stagnationMonitor) stagnationMonitor->printSummary();
             population->getPopulationMember(0).printRepresentation();
         }
 
+        /// @brief Run generations without printing until the objective has
+        /// been called at least callBudget times in total or a termination
+        /// flag fires. Can be called repeatedly with growing budgets to run in
+        /// slices, e.g. by HyperparameterSweep
+        /// @return true if a termination flag has fired
+        bool runUntil(int callBudget) {
+            setup();
+            while(objective->getCallCount() < callBudget) {
+                if(terminationManager.checkTermination()) return true;
+                generation();
+            }
+            return terminationManager.checkTermination();
+        }
+
+        /// @brief Best progressScore() seen so far, set once run() or runUntil() starts
+        double getBestScore() const {return isSetup ? bestScore : progressScore();}
+
+        /// @brief (fitness function calls, best score so far) after every generation
+        const std::vector<std::pair<int, double>>& getConvergenceCurve() const {return convergenceCurve;}
+
         void addTerminationFlag(std::unique_ptr<TerminationFlagBase> terminationFlag) {
             terminationManager.addTerminationFlag(std::move(terminationFlag));
         }
@@ -45,14 +63,49 @@ class GeneticAlgorithm {
 
         void setProgressReportCount(int reportCount=-1) {this->reportCount = reportCount;}
 
+        /// @brief Check for stagnation after every generation and reseed the
+        /// population when found, nullptr disables the check
+        void setStagnationMonitor(std::unique_ptr<StagnationMonitor> stagnationMonitor) {this->stagnationMonitor = std::move(stagnationMonitor);}
+
+        /// @brief Get the stagnation monitor, nullptr if none is set
+        const StagnationMonitor* getStagnationMonitor() const {return stagnationMonitor.get();}
+
     protected:
         virtual void geneticAlgorithm() = 0;
+
+        /// @brief Score of the sorted population that getBestScore(), the
+        /// convergence curve and the stagnation monitor track, lower is better.
+        /// The best member's score by default, override when member scores are
+        /// not comparable between generations
+        virtual double progressScore() const {return (*population)[0].getScore();}
+
         std::unique_ptr<Population> population;
         std::unique_ptr<ObjectiveBase> objective;
         TerminationManager terminationManager = TerminationManager();
         int reportCount = -1;
+        std::unique_ptr<StagnationMonitor> stagnationMonitor;
     private:
+        double bestScore = 0.0;
+        std::vector<std::pair<int, double>> convergenceCurve;
+        bool isSetup = false;
+
+        void generation() {
+            geneticAlgorithm();
+            population->sort();
+            double score = progressScore();
+            bestScore = std::min(bestScore, score);
+            if(stagnationMonitor && stagnationMonitor->update(*population, terminationManager, score)) {
+                population->sort();
+            }
+            convergenceCurve.push_back(std::make_pair(objective->getCallCount(), bestScore));
+        }
+
         void setup() {
+            if(isSetup) return;
+            isSetup = true;
+            population->sort();
+            bestScore = progressScore();
+            convergenceCurve.push_back(std::make_pair(objective->getCallCount(), bestScore));
             terminationManager.setProgressReportCount(reportCount);
             if(terminationManager.size() < 1) {
                 std::cerr << "At least one termination condition must be provided\nExiting program\n";
@@ -0,0 +1,231 @@
+#ifndef HYPERPARAMETERSWEEP_HPP
+#define HYPERPARAMETERSWEEP_HPP
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include "GeneticAlgorithm.hpp"
+#include "TerminationCondition.hpp"
+#include "RandomStream.hpp"
+#include "Crossover.hpp"
+
+/// @brief Hyperparameters of one sweep run, read by the run factory
+struct SweepConfiguration {
+    int populationSize = 100;
+    double crossoverRate = 0.8;
+    double mutationRate = 0.3;
+    int eliteCount = 10;
+};
+
+/// @brief Runs many GeneticAlgorithm configurations concurrently in one
+/// process with successive halving. Every run is built by the factory from its
+/// configuration and one shared, immutable Context (e.g. a distance matrix
+/// computed once), which objectives should hold by std::shared_ptr<const
+/// Context> rather than copy. Runs are jobs on a pool of numThreads workers.
+/// Each run has its own RandomStream engines and parallel breeding seed,
+/// derived from the sweep seed and the run id and swapped in whenever the run
+/// is resumed, so results do not depend on thread count or scheduling.
+///
+/// Rung r gives every surviving run a total budget of minBudget * eta^r
+/// fitness function calls (the last rung maxBudget), then keeps the best
+/// ceil(survivors / eta) by best score and stops the rest. Each run records
+/// its convergence curve through GeneticAlgorithm::getConvergenceCurve().
+/// The factory is called on a worker thread and must add any termination
+/// flags itself, a FitnessFunctionCallTerminationFlag(maxBudget) is added.
+template <typename Context>
+class HyperparameterSweep {
+    public:
+        using RunFactory = std::function<std::unique_ptr<GeneticAlgorithm>(const SweepConfiguration&, const std::shared_ptr<const Context>&)>;
+
+        /// @brief Outcome of one configuration
+        struct RunResult {
+            int id;
+            SweepConfiguration configuration;
+            double bestScore;
+            int evaluations;
+            /// @brief Rung the run was stopped after, -1 if it finished
+            int stoppedAtRung;
+            std::vector<std::pair<int, double>> convergenceCurve;
+        };
+
+        /// @param context Problem data shared read only by every run
+        /// @param factory Builds a run's GeneticAlgorithm from its configuration
+        /// @param numThreads Worker threads, defaults to hardware concurrency
+        /// @param seed Sweep seed the run streams are derived from
+        HyperparameterSweep(std::shared_ptr<const Context> context, RunFactory factory, int numThreads=-1, uint64_t seed=RandomStream::engine64()())
+        : context(context), factory(factory), numThreads(numThreads), seed(seed) {
+            if(this->numThreads < 1) this->numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        void addConfiguration(const SweepConfiguration& configuration) {
+            Run run;
+            run.result.id = runs.size();
+            run.result.configuration = configuration;
+            run.result.bestScore = 0.0;
+            run.result.evaluations = 0;
+            run.result.stoppedAtRung = -1;
+            runs.push_back(std::move(run));
+        }
+
+        /// @brief Add every combination of the given values
+        void addGrid(const std::vector<int>& populationSizes, const std::vector<double>& crossoverRates, const std::vector<double>& mutationRates, const std::vector<int>& eliteCounts) {
+            for(int populationSize : populationSizes) {
+                for(double crossoverRate : crossoverRates) {
+                    for(double mutationRate : mutationRates) {
+                        for(int eliteCount : eliteCounts) {
+                            addConfiguration(SweepConfiguration{populationSize, crossoverRate, mutationRate, eliteCount});
+                        }
+                    }
+                }
+            }
+        }
+
+        /// @brief Run the sweep with successive halving
+        /// @param minBudget Fitness function calls per run in the first rung
+        /// @param maxBudget Fitness function calls of the runs that finish
+        /// @param eta Budget growth and elimination factor per rung
+        /// @return Results of every run, in the order configurations were added
+        std::vector<RunResult> run(int minBudget, int maxBudget, int eta=3) {
+            if(runs.empty()) {
+                std::cerr << "HyperparameterSweep::run\nNo configurations have been added\nExiting Program\n";
+                exit(-1);
+            }
+            if(eta < 2 || minBudget < 1 || maxBudget < minBudget) {
+                std::cerr << "HyperparameterSweep::run\nNeed eta >= 2 and 1 <= minBudget <= maxBudget\nExiting Program\n";
+                exit(-1);
+            }
+            this->maxBudget = maxBudget;
+            std::vector<int> survivors(runs.size());
+            for(size_t i = 0; i < runs.size(); i++) survivors[i] = i;
+
+            long long budget = minBudget;
+            for(int rung = 0; ; rung++) {
+                bool lastRung = budget >= maxBudget || survivors.size() <= 1;
+                if(lastRung) budget = maxBudget;
+                runRung(survivors, static_cast<int>(budget));
+                if(lastRung) break;
+
+                std::stable_sort(survivors.begin(), survivors.end(), [this](int a, int b) {
+                    return runs[a].result.bestScore < runs[b].result.bestScore;
+                });
+                size_t keep = (survivors.size() + eta - 1) / eta;
+                for(size_t i = keep; i < survivors.size(); i++) {
+                    runs[survivors[i]].result.stoppedAtRung = rung;
+                    runs[survivors[i]].algorithm.reset();
+                }
+                survivors.resize(keep);
+                budget *= eta;
+            }
+            std::vector<RunResult> results;
+            for(const Run& run : runs) results.push_back(run.result);
+            return results;
+        }
+
+        /// @brief Result of the best scoring run that finished
+        const RunResult& getBest() const {
+            const RunResult* best = nullptr;
+            for(const Run& run : runs) {
+                if(run.result.stoppedAtRung != -1) continue;
+                if(!best || run.result.bestScore < best->bestScore) best = &run.result;
+            }
+            if(!best) {
+                std::cerr << "HyperparameterSweep::getBest\nNo run has finished, call run() first\nExiting Program\n";
+                exit(-1);
+            }
+            return *best;
+        }
+
+        void printSummary() const {
+            std::cout << std::setw(5) << "id" << std::setw(12) << "population" << std::setw(12) << "crossover"
+                      << std::setw(12) << "mutation" << std::setw(8) << "elite" << std::setw(14) << "best"
+                      << std::setw(12) << "calls" << std::setw(10) << "stopped" << "\n";
+            for(const Run& run : runs) {
+                const RunResult& result = run.result;
+                std::cout << std::setw(5) << result.id << std::setw(12) << result.configuration.populationSize
+                          << std::setw(12) << result.configuration.crossoverRate << std::setw(12) << result.configuration.mutationRate
+                          << std::setw(8) << result.configuration.eliteCount << std::setw(14) << result.bestScore
+                          << std::setw(12) << result.evaluations << std::setw(10);
+                if(result.stoppedAtRung == -1) {
+                    std::cout << "-";
+                } else {
+                    std::cout << result.stoppedAtRung;
+                }
+                std::cout << "\n";
+            }
+        }
+
+    private:
+        struct Run {
+            RunResult result;
+            std::unique_ptr<GeneticAlgorithm> algorithm;
+            std::mt19937 engine;
+            std::mt19937_64 engine64;
+            Variation::ParallelBreedingState breedingState;
+            bool started = false;
+        };
+
+        std::shared_ptr<const Context> context;
+        RunFactory factory;
+        int numThreads;
+        uint64_t seed;
+        int maxBudget = 0;
+        std::vector<Run> runs;
+
+        void runRung(const std::vector<int>& jobs, int budget) {
+            std::atomic<size_t> next(0);
+            auto worker = [&]() {
+                for(size_t job = next++; job < jobs.size(); job = next++) {
+                    resume(runs[jobs[job]], budget);
+                }
+            };
+            int workers = std::min<int>(numThreads, jobs.size());
+            if(workers <= 1) {
+                worker();
+                return;
+            }
+            std::vector<std::thread> threads;
+            for(int t = 0; t < workers; t++) threads.emplace_back(worker);
+            for(std::thread& thread : threads) thread.join();
+        }
+
+        /// @brief Swap the run's streams in, advance it to budget, swap them out
+        void resume(Run& run, int budget) {
+            std::mt19937 threadEngine = RandomStream::engine();
+            std::mt19937_64 threadEngine64 = RandomStream::engine64();
+            Variation::ParallelBreedingState threadBreedingState = Variation::parallelBreedingState();
+            if(!run.started) {
+                std::seed_seq seedSequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), static_cast<uint32_t>(run.result.id)};
+                run.engine.seed(seedSequence);
+                run.engine64.seed(seedSequence);
+                run.breedingState.seed = run.engine64();
+                run.breedingState.calls = 0;
+            }
+            RandomStream::engine() = run.engine;
+            RandomStream::engine64() = run.engine64;
+            Variation::parallelBreedingState() = run.breedingState;
+
+            if(!run.started) {
+                run.algorithm = factory(run.result.configuration, context);
+                run.algorithm->addTerminationFlag(std::make_unique<FitnessFunctionCallTerminationFlag>(maxBudget));
+                run.started = true;
+            }
+            run.algorithm->runUntil(budget);
+            run.result.bestScore = run.algorithm->getBestScore();
+            run.result.evaluations = run.algorithm->getConvergenceCurve().back().first;
+            run.result.convergenceCurve = run.algorithm->getConvergenceCurve();
+
+            run.engine = RandomStream::engine();
+            run.engine64 = RandomStream::engine64();
+            run.breedingState = Variation::parallelBreedingState();
+            RandomStream::engine() = threadEngine;
+            RandomStream::engine64() = threadEngine64;
+            Variation::parallelBreedingState() = threadBreedingState;
+        }
+};
+#endif
@@ -0,0 +1,451 @@
+#ifndef INITIALISATION_HPP
+#define INITIALISATION_HPP
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <queue>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <iostream>
+#include "Representation.hpp"
+#include "CompactPermutationRepresentation.hpp"
+#include "RandomStream.hpp"
+
+/// @brief Builders of initial populations for permutation (tour) problems.
+/// generateTours() fills members on several threads from a weighted mix of
+/// TourGenerators, the returned representations are handed to the
+/// GeneticAlgorithm or Population constructor, which evaluates them with one
+/// ObjectiveBase::evaluateBatch() call (parallel for thread safe or out of
+/// process objectives)
+namespace Initialisation {
+    /// @brief City coordinates of a TSP-like instance with each city's
+    /// nearest neighbours, built once and shared read only by the heuristic
+    /// generators
+    class TourInstance {
+        public:
+            /// @param x City x coordinates
+            /// @param y City y coordinates
+            /// @param neighbourCount Nearest neighbours kept per city
+            /// @param numThreads Worker threads, defaults to hardware concurrency
+            TourInstance(std::vector<double> x, std::vector<double> y, int neighbourCount=10, int numThreads=-1) : x(std::move(x)), y(std::move(y)) {
+                if(this->x.size() != this->y.size() || this->x.empty()) {
+                    std::cerr << "Initialisation::TourInstance\nNeed the same, non zero number of x and y coordinates\nExiting Program\n";
+                    exit(-1);
+                }
+                if(neighbourCount < 1) {
+                    std::cerr << "Initialisation::TourInstance\nneighbourCount must be at least 1, got " << neighbourCount << "\nExiting Program\n";
+                    exit(-1);
+                }
+                this->neighbourCount = std::min<int>(neighbourCount, this->x.size() - 1);
+                findNeighbours(numThreads);
+            }
+
+            int size() const {return x.size();}
+
+            double getX(int city) const {return x[city];}
+
+            double getY(int city) const {return y[city];}
+
+            double distance(int a, int b) const {return std::hypot(x[a] - x[b], y[a] - y[b]);}
+
+            int getNeighbourCount() const {return neighbourCount;}
+
+            /// @brief Nearest neighbours of city, closest first
+            GeneView<const int> getNeighbours(int city) const {
+                return GeneView<const int>(neighbours.data() + static_cast<size_t>(city) * neighbourCount, neighbourCount);
+            }
+
+        private:
+            std::vector<double> x;
+            std::vector<double> y;
+            int neighbourCount;
+            std::vector<int> neighbours;
+
+            /// @brief k nearest neighbours of every city from a uniform grid of
+            /// about two cities per cell, searched in rings outward from the
+            /// city's cell until no closer city can remain
+            void findNeighbours(int numThreads) {
+                int n = size();
+                neighbours.assign(static_cast<size_t>(n) * neighbourCount, 0);
+                if(neighbourCount == 0) return;
+
+                auto [minX, maxX] = std::minmax_element(x.begin(), x.end());
+                auto [minY, maxY] = std::minmax_element(y.begin(), y.end());
+                double originX = *minX, originY = *minY;
+                int side = std::max(1, static_cast<int>(std::sqrt(n / 2.0)));
+                double cellWidth = *maxX > *minX ? (*maxX - *minX) / side : 1.0;
+                double cellHeight = *maxY > *minY ? (*maxY - *minY) / side : 1.0;
+                double cellMin = std::min(cellWidth, cellHeight);
+                auto cellOf = [&](int city, int& cx, int& cy) {
+                    cx = std::min(side - 1, static_cast<int>((x[city] - originX) / cellWidth));
+                    cy = std::min(side - 1, static_cast<int>((y[city] - originY) / cellHeight));
+                };
+
+                //Cities bucketed by cell, cell c holds cellCities[cellStart[c], cellStart[c + 1])
+                std::vector<int> cellStart(side * side + 1, 0);
+                std::vector<int> cellCities(n);
+                for(int city = 0; city < n; city++) {
+                    int cx, cy;
+                    cellOf(city, cx, cy);
+                    cellStart[cy * side + cx + 1]++;
+                }
+                std::partial_sum(cellStart.begin(), cellStart.end(), cellStart.begin());
+                std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+                for(int city = 0; city < n; city++) {
+                    int cx, cy;
+                    cellOf(city, cx, cy);
+                    cellCities[fill[cy * side + cx]++] = city;
+                }
+
+                auto searchSlice = [&](int t, int numSlices) {
+                    std::priority_queue<std::pair<double, int>> nearest;
+                    auto visitCell = [&](int city, int cx, int cy) {
+                        if(cx < 0 || cy < 0 || cx >= side || cy >= side) return;
+                        int cell = cy * side + cx;
+                        for(int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+                            int other = cellCities[i];
+                            if(other == city) continue;
+                            double d = distance(city, other);
+                            if(static_cast<int>(nearest.size()) < neighbourCount) {
+                                nearest.emplace(d, other);
+                            } else if(d < nearest.top().first) {
+                                nearest.pop();
+                                nearest.emplace(d, other);
+                            }
+                        }
+                    };
+                    for(int city = t * n / numSlices; city < (t + 1) * n / numSlices; city++) {
+                        int cx, cy;
+                        cellOf(city, cx, cy);
+                        for(int ring = 0; ring <= side; ring++) {
+                            if(ring == 0) {
+                                visitCell(city, cx, cy);
+                            } else {
+                                for(int d = -ring; d <= ring; d++) {
+                                    visitCell(city, cx + d, cy - ring);
+                                    visitCell(city, cx + d, cy + ring);
+                                }
+                                for(int d = -ring + 1; d <= ring - 1; d++) {
+                                    visitCell(city, cx - ring, cy + d);
+                                    visitCell(city, cx + ring, cy + d);
+                                }
+                            }
+                            //Cities outside the rings searched are at least ring cells away
+                            if(static_cast<int>(nearest.size()) == neighbourCount && nearest.top().first <= ring * cellMin) break;
+                        }
+                        int* cityNeighbours = neighbours.data() + static_cast<size_t>(city) * neighbourCount;
+                        for(int k = neighbourCount - 1; k >= 0; k--) {
+                            cityNeighbours[k] = nearest.top().second;
+                            nearest.pop();
+                        }
+                    }
+                };
+
+                if(numThreads < 1) numThreads = std::max(1u, std::thread::hardware_concurrency());
+                numThreads = std::min(numThreads, n);
+                if(numThreads == 1) {
+                    searchSlice(0, 1);
+                } else {
+                    std::vector<std::thread> threads;
+                    for(int t = 0; t < numThreads; t++) threads.emplace_back(searchSlice, t, numThreads);
+                    for(std::thread& thread : threads) thread.join();
+                }
+            }
+    };
+
+    /// @brief Writes a complete tour (a permutation of 0 .. tour.size() - 1)
+    /// into tour, drawing any randomness from mt. Called concurrently from
+    /// several threads, so must not modify shared state
+    using TourGenerator = std::function<void(GeneView<int> tour, std::mt19937& mt)>;
+
+    /// @brief A generator and its share of the population
+    struct WeightedGenerator {
+        TourGenerator generator;
+        double weight;
+    };
+
+    /// @brief Uniformly random permutation
+    TourGenerator randomTour() {
+        return [](GeneView<int> tour, std::mt19937& mt) {
+            std::iota(tour.begin(), tour.end(), 0);
+            std::shuffle(tour.begin(), tour.end(), mt);
+        };
+    }
+
+    /// @brief Nearest neighbour tour from a random start city. The next city is
+    /// the closest unvisited one in the current city's neighbour list, or by a
+    /// scan of every unvisited city when the whole list has been visited
+    TourGenerator nearestNeighbourTour(std::shared_ptr<const TourInstance> instance) {
+        return [instance](GeneView<int> tour, std::mt19937& mt) {
+            int n = instance->size();
+            //Unvisited cities packed at the front of unvisited, position[c] is
+            //c's index there
+            std::vector<int> unvisited(n);
+            std::vector<int> position(n);
+            std::iota(unvisited.begin(), unvisited.end(), 0);
+            std::iota(position.begin(), position.end(), 0);
+            int remaining = n;
+            auto visit = [&](int city) {
+                int last = unvisited[--remaining];
+                unvisited[position[city]] = last;
+                position[last] = position[city];
+                unvisited[remaining] = city;
+                position[city] = remaining;
+            };
+            int current = std::uniform_int_distribution<int>(0, n - 1)(mt);
+            visit(current);
+            tour[0] = current;
+            for(int i = 1; i < n; i++) {
+                int next = -1;
+                for(int neighbour : instance->getNeighbours(current)) {
+                    if(position[neighbour] < remaining) {
+                        next = neighbour;
+                        break;
+                    }
+                }
+                if(next == -1) {
+                    double nearest = std::numeric_limits<double>::infinity();
+                    for(int u = 0; u < remaining; u++) {
+                        double d = instance->distance(current, unvisited[u]);
+                        if(d < nearest) {
+                            nearest = d;
+                            next = unvisited[u];
+                        }
+                    }
+                }
+                visit(next);
+                tour[i] = next;
+                current = next;
+            }
+        };
+    }
+
+    /// @brief Greedy edge tour. Candidate edges from the neighbour lists are
+    /// taken shortest first, skipping any that would give a city three edges
+    /// or close a cycle early, then the fragments are joined nearest end
+    /// first. Each edge length is scaled by a random factor in
+    /// [1, 1 + noise] so members differ, noise = 0 builds the same tour every
+    /// time
+    TourGenerator greedyEdgeTour(std::shared_ptr<const TourInstance> instance, double noise=0.1) {
+        struct Edge {
+            double length;
+            int a, b;
+        };
+        //Candidate edges are shared by every call
+        auto candidates = std::make_shared<std::vector<Edge>>();
+        for(int city = 0; city < instance->size(); city++) {
+            for(int neighbour : instance->getNeighbours(city)) {
+                //Keep each edge once, from the lower city unless only the higher lists it
+                bool listedByNeighbour = false;
+                for(int back : instance->getNeighbours(neighbour)) listedByNeighbour |= back == city;
+                if(city < neighbour || !listedByNeighbour) candidates->push_back(Edge{instance->distance(city, neighbour), city, neighbour});
+            }
+        }
+        std::shared_ptr<const std::vector<Edge>> edges = candidates;
+
+        return [instance, edges, noise](GeneView<int> tour, std::mt19937& mt) {
+            int n = instance->size();
+            std::uniform_real_distribution<double> realDist(1.0, 1.0 + noise);
+            std::vector<std::pair<double, int>> order(edges->size());
+            for(size_t e = 0; e < edges->size(); e++) order[e] = std::make_pair((*edges)[e].length * (noise > 0 ? realDist(mt) : 1.0), static_cast<int>(e));
+            std::sort(order.begin(), order.end());
+
+            std::vector<int> adjacent(2 * static_cast<size_t>(n), -1);
+            std::vector<int> degree(n, 0);
+            std::vector<int> parent(n);
+            std::iota(parent.begin(), parent.end(), 0);
+            auto find = [&](int city) {
+                while(parent[city] != city) {
+                    parent[city] = parent[parent[city]];
+                    city = parent[city];
+                }
+                return city;
+            };
+            int added = 0;
+            for(const std::pair<double, int>& candidate : order) {
+                if(added == n - 1) break;
+                const Edge& edge = (*edges)[candidate.second];
+                if(degree[edge.a] == 2 || degree[edge.b] == 2) continue;
+                int rootA = find(edge.a), rootB = find(edge.b);
+                if(rootA == rootB) continue;
+                parent[rootA] = rootB;
+                adjacent[2 * edge.a + degree[edge.a]++] = edge.b;
+                adjacent[2 * edge.b + degree[edge.b]++] = edge.a;
+                added++;
+            }
+
+            //Walk the fragments, joining each fragment's far end to the
+            //nearest end of a fragment not yet walked
+            std::vector<int> ends;
+            for(int city = 0; city < n; city++) {
+                if(degree[city] < 2) ends.push_back(city);
+            }
+            std::vector<char> visited(n, 0);
+            int start = ends[std::uniform_int_distribution<int>(0, ends.size() - 1)(mt)];
+            int length = 0;
+            while(true) {
+                int previous = -1, current = start;
+                while(current != -1) {
+                    visited[current] = 1;
+                    tour[length++] = current;
+                    int next = adjacent[2 * current] != previous ? adjacent[2 * current] : adjacent[2 * current + 1];
+                    if(next != -1 && visited[next]) next = -1;
+                    previous = current;
+                    current = next;
+                }
+                if(length == n) break;
+                double nearest = std::numeric_limits<double>::infinity();
+                size_t kept = 0;
+                for(size_t e = 0; e < ends.size(); e++) {
+                    if(visited[ends[e]]) continue;
+                    ends[kept++] = ends[e];
+                    double d = instance->distance(previous, ends[e]);
+                    if(d < nearest) {
+                        nearest = d;
+                        start = ends[e];
+                    }
+                }
+                ends.resize(kept);
+            }
+        };
+    }
+
+    /// @brief Position of (x, y) along a Hilbert curve over a 2^16 x 2^16 grid
+    uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+        const uint32_t n = 1u << 16;
+        uint64_t index = 0;
+        for(uint32_t s = n / 2; s > 0; s /= 2) {
+            uint32_t rx = (x & s) > 0;
+            uint32_t ry = (y & s) > 0;
+            index += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+            if(ry == 0) {
+                if(rx == 1) {
+                    x = n - 1 - x;
+                    y = n - 1 - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return index;
+    }
+
+    /// @brief Cities in the order a Hilbert curve visits them. Each call
+    /// places the cities, scaled to half the curve's square, at a random
+    /// offset in it and applies a random symmetry of the square, so members
+    /// differ in where the curve cuts between neighbouring cities
+    TourGenerator spaceFillingCurveTour(std::shared_ptr<const TourInstance> instance) {
+        return [instance](GeneView<int> tour, std::mt19937& mt) {
+            int n = instance->size();
+            double minX = instance->getX(0), minY = instance->getY(0), extent = 0.0;
+            for(int city = 0; city < n; city++) {
+                minX = std::min(minX, instance->getX(city));
+                minY = std::min(minY, instance->getY(city));
+            }
+            for(int city = 0; city < n; city++) {
+                extent = std::max({extent, instance->getX(city) - minX, instance->getY(city) - minY});
+            }
+            if(extent == 0.0) extent = 1.0;
+
+            std::uniform_real_distribution<double> realDist(0.0, 1.0);
+            double shiftX = realDist(mt), shiftY = realDist(mt);
+            int symmetry = std::uniform_int_distribution<int>(0, 7)(mt);
+            const double scale = (1u << 16) - 1;
+            std::vector<std::pair<uint64_t, int>> keys(n);
+            for(int city = 0; city < n; city++) {
+                double u = 0.5 * ((instance->getX(city) - minX) / extent + shiftX);
+                double v = 0.5 * ((instance->getY(city) - minY) / extent + shiftY);
+                if(symmetry & 1) u = 1.0 - u;
+                if(symmetry & 2) v = 1.0 - v;
+                if(symmetry & 4) std::swap(u, v);
+                keys[city] = std::make_pair(hilbertIndex(static_cast<uint32_t>(u * scale), static_cast<uint32_t>(v * scale)), city);
+            }
+            std::sort(keys.begin(), keys.end());
+            for(int city = 0; city < n; city++) tour[city] = keys[city].second;
+        };
+    }
+
+    /// @brief Build count tours of length genes on several threads. Members are
+    /// shared between the generators in proportion to their weights, in the
+    /// order given, and member i draws from an engine seeded by (seed, i), so
+    /// the result depends only on the seed, never on the number of threads
+    /// @param prototype Representation whose type the members take
+    /// @param count Number of members
+    /// @param length Genes per member
+    /// @param generators Generators and their weights
+    /// @param numThreads Worker threads, defaults to hardware concurrency
+    /// @param seed Seed the member engines are derived from
+    /// @return Unevaluated representations, ready for the GeneticAlgorithm or
+    /// Population constructor
+    std::vector<std::unique_ptr<RepresentationBase>> generateTours(const RepresentationBase& prototype, int count, int length, const std::vector<WeightedGenerator>& generators, int numThreads=-1, uint64_t seed=RandomStream::engine64()()) {
+        std::vector<std::unique_ptr<RepresentationBase>> representations;
+        if(count <= 0) return representations;
+        double totalWeight = 0.0;
+        for(const WeightedGenerator& generator : generators) {
+            if(generator.weight < 0.0 || !generator.generator) {
+                std::cerr << "Initialisation::generateTours\nGenerators must be set and have non negative weights\nExiting Program\n";
+                exit(-1);
+            }
+            totalWeight += generator.weight;
+        }
+        if(totalWeight <= 0.0) {
+            std::cerr << "Initialisation::generateTours\nNeed at least one generator with a positive weight\nExiting Program\n";
+            exit(-1);
+        }
+
+        //Member i is built by generators[owner[i]], shares rounded by largest remainder
+        std::vector<int> owner;
+        owner.reserve(count);
+        std::vector<std::pair<double, int>> remainders;
+        std::vector<int> shares(generators.size());
+        int assigned = 0;
+        for(size_t g = 0; g < generators.size(); g++) {
+            double exact = count * generators[g].weight / totalWeight;
+            shares[g] = static_cast<int>(exact);
+            assigned += shares[g];
+            remainders.emplace_back(-(exact - shares[g]), g);
+        }
+        std::sort(remainders.begin(), remainders.end());
+        for(int r = 0; assigned < count; r++, assigned++) shares[remainders[r].second]++;
+        for(size_t g = 0; g < generators.size(); g++) owner.insert(owner.end(), shares[g], g);
+
+        std::vector<int> genes(static_cast<size_t>(count) * length);
+        auto buildSlice = [&](int t, int numSlices) {
+            std::mt19937 mt;
+            for(int i = t * count / numSlices; i < (t + 1) * count / numSlices; i++) {
+                std::seed_seq seedSequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), static_cast<uint32_t>(i)};
+                mt.seed(seedSequence);
+                generators[owner[i]].generator(GeneView<int>(genes.data() + static_cast<size_t>(i) * length, length), mt);
+            }
+        };
+        if(numThreads < 1) numThreads = std::max(1u, std::thread::hardware_concurrency());
+        numThreads = std::min(numThreads, count);
+        if(numThreads == 1) {
+            buildSlice(0, 1);
+        } else {
+            std::vector<std::thread> threads;
+            for(int t = 0; t < numThreads; t++) threads.emplace_back(buildSlice, t, numThreads);
+            for(std::thread& thread : threads) thread.join();
+        }
+
+        representations.reserve(count);
+        for(int i = 0; i < count; i++) {
+            GeneWriter<int> writer(prototype, length);
+            std::copy(genes.begin() + static_cast<size_t>(i) * length, genes.begin() + static_cast<size_t>(i + 1) * length, writer.genes().begin());
+            representations.push_back(writer.release());
+        }
+        return representations;
+    }
+
+    /// @brief generateTours() into CompactPermutationRepresentation members of
+    /// the narrowest index type able to hold length cities, see
+    /// compactPermutationPrototype()
+    std::vector<std::unique_ptr<RepresentationBase>> generateTours(int count, int length, const std::vector<WeightedGenerator>& generators, int numThreads=-1, uint64_t seed=RandomStream::engine64()()) {
+        return generateTours(*compactPermutationPrototype(length), count, length, generators, numThreads, seed);
+    }
+}
+#endif
@@ -0,0 +1,49 @@
+#ifndef INTEGERVECTORREPRESENTATION_HPP
+#define INTEGERVECTORREPRESENTATION_HPP
+#include <vector>
+#include <string>
+#include <sstream>
+#include <memory>
+#include "Representation.hpp"
+
+/// @brief Integer chromosome, e.g. a permutation for tour problems. Exposes
+/// its genes through getIntegerGenes() / getMutableIntegerGenes() so the
+/// built-in operators read parents and write children without copying
+class IntegerVectorRepresentation : public RepresentationBase {
+    public:
+        IntegerVectorRepresentation() {}
+
+        IntegerVectorRepresentation(const std::vector<int>& genes) : genes(genes) {}
+
+        virtual std::string toString() const override {
+            std::stringstream ss;
+            for(int gene : genes) {
+                ss << gene << ",";
+            }
+            return ss.str();
+        }
+
+        virtual int size() const override {return genes.size();}
+
+        virtual std::unique_ptr<RepresentationBase> emptyCopy() const override {
+            return std::make_unique<IntegerVectorRepresentation>();
+        }
+
+        virtual std::unique_ptr<RepresentationBase> deepCopy() const override {
+            return std::make_unique<IntegerVectorRepresentation>(genes);
+        }
+
+        virtual std::vector<int> getIntegerVectorRepresentation() const override {return genes;}
+
+        virtual void setIntegerVectorRepresentation(std::vector<int>& rep) override {genes = rep;}
+
+        virtual GeneView<const int> getIntegerGenes() const override {return GeneView<const int>(genes.data(), genes.size());}
+
+        virtual GeneView<int> getMutableIntegerGenes() override {return GeneView<int>(genes);}
+
+        virtual bool hasMutableIntegerGenes() const override {return true;}
+
+    protected:
+        std::vector<int> genes;
+};
+#endif
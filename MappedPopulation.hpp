@@ -0,0 +1,424 @@
+#ifndef MAPPEDPOPULATION_HPP
+#define MAPPEDPOPULATION_HPP
+#include <vector>
+#include <string>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include "Representation.hpp"
+#include "Objective.hpp"
+#include "phenotype.hpp"
+#include "TerminationCondition.hpp"
+#include "RandomStream.hpp"
+
+/// @brief Out-of-core population for populations too large to hold as
+/// PhenotypeBase objects. Genomes are fixed length records of Gene (int,
+/// double, or uint16_t / uint32_t for permutations, see withPermutationIndex())
+/// in a memory mapped file, only a score and a record slot per member
+/// are kept in memory (16 bytes). Members are indexed best -> worst after
+/// sort() like Population, records never move unless compact() is called and
+/// removed members' slots are reused. Genomes are turned into phenotypes only
+/// in batches of evaluationBatchSize for ObjectiveBase::evaluateBatch(), from
+/// the emptyPhenotype / emptyRepresentation prototypes. The overloads of
+/// Selection::binaryTournamentSelection(), Variation::mappedCrossover(),
+/// Variation::mappedMutation() and Reproduction::nElitism() below visit
+/// records in file order and prefetch ahead, so paging stays sequential.
+/// POSIX only.
+template <typename Gene=int>
+class MappedPopulation {
+    static_assert(std::is_same<Gene, int>::value || std::is_same<Gene, double>::value || std::is_same<Gene, uint16_t>::value || std::is_same<Gene, uint32_t>::value, "MappedPopulation<Gene> supports int, double, uint16_t and uint32_t genes");
+
+    public:
+        /// @param path File backing the records, created or truncated
+        /// @param genomeLength Genes per record
+        /// @param capacity Maximum number of records, including children bred
+        /// before the population is truncated again
+        /// @param emptyPhenotype Phenotype prototype used for evaluation
+        /// @param emptyRepresentation Representation prototype used for evaluation
+        /// @param objective Objective genomes are evaluated with
+        /// @param evaluationBatchSize Genomes turned into phenotypes at once
+        /// @param removeFile Delete the backing file on destruction
+        MappedPopulation(const std::string& path, int genomeLength, int capacity, std::shared_ptr<PhenotypeBase> emptyPhenotype, std::unique_ptr<RepresentationBase> emptyRepresentation, std::unique_ptr<ObjectiveBase>& objective, int evaluationBatchSize=1024, bool removeFile=true)
+        : path(path), genomeLength(genomeLength), capacity(capacity), emptyPhenotype(emptyPhenotype), emptyRepresentation(std::move(emptyRepresentation)), objective(objective), evaluationBatchSize(std::max(1, evaluationBatchSize)), removeFile(removeFile) {
+            if(!objective) {
+                std::cerr << "MappedPopulation::MappedPopulation\nCould not construct population because objective pointer is nullptr\nExiting Program\n";
+                exit(-1);
+            }
+            if(genomeLength < 1 || capacity < 1) {
+                std::cerr << "MappedPopulation::MappedPopulation\ngenomeLength and capacity must be at least 1\nExiting Program\n";
+                exit(-1);
+            }
+            if(std::is_same<Gene, uint16_t>::value && genomeLength > static_cast<int>(std::numeric_limits<uint16_t>::max()) + 1) {
+                std::cerr << "MappedPopulation::MappedPopulation\nuint16_t genes hold permutations of at most 65536 elements, got " << genomeLength << "\nExiting Program\n";
+                exit(-1);
+            }
+            recordBytes = static_cast<size_t>(genomeLength) * sizeof(Gene);
+            mappedBytes = recordBytes * capacity;
+            fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+            if(fd < 0 || ftruncate(fd, mappedBytes) != 0) {
+                std::cerr << "MappedPopulation::MappedPopulation\nCould not create " << path << ": " << std::strerror(errno) << "\nExiting Program\n";
+                exit(-1);
+            }
+            void* mapping = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if(mapping == MAP_FAILED) {
+                std::cerr << "MappedPopulation::MappedPopulation\nCould not map " << path << ": " << std::strerror(errno) << "\nExiting Program\n";
+                exit(-1);
+            }
+            records = static_cast<Gene*>(mapping);
+            pageBytes = sysconf(_SC_PAGESIZE);
+        }
+
+        ~MappedPopulation() {
+            if(records) munmap(records, mappedBytes);
+            if(fd >= 0) close(fd);
+            if(removeFile) unlink(path.c_str());
+        }
+
+        MappedPopulation(const MappedPopulation&) = delete;
+        MappedPopulation& operator=(const MappedPopulation&) = delete;
+
+        /// @brief Number of members
+        int size() const {return members.size();}
+
+        int getCapacity() const {return capacity;}
+
+        int getGenomeLength() const {return genomeLength;}
+
+        /// @brief Score of member n
+        double getScore(int n) const {return members[n].score;}
+
+        /// @brief Read only view of member n's genes in the mapped file
+        GeneView<const Gene> getGenes(int n) const {
+            return GeneView<const Gene>(records + static_cast<size_t>(members[n].slot) * genomeLength, genomeLength);
+        }
+
+        /// @brief Writable view of member n's genes, its score is stale until
+        /// evaluateMembers() is called for it
+        GeneView<Gene> getMutableGenes(int n) {
+            return GeneView<Gene>(records + static_cast<size_t>(members[n].slot) * genomeLength, genomeLength);
+        }
+
+        /// @brief Append a member with a free record and no score yet
+        /// @return int index of the new member
+        int addUnevaluatedMember() {
+            int slot;
+            if(!freeSlots.empty()) {
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+            } else if(usedSlots < capacity) {
+                slot = usedSlots++;
+            } else {
+                std::cerr << "MappedPopulation::addUnevaluatedMember\nCapacity of " << capacity << " records exceeded\nExiting Program\n";
+                exit(-1);
+            }
+            members.push_back(Member{std::numeric_limits<double>::quiet_NaN(), slot});
+            return members.size() - 1;
+        }
+
+        /// @brief Generate and evaluate count new members
+        /// @param generator Callable (GeneView<Gene> genes, std::mt19937& mt)
+        /// filling one genome
+        void addMembers(int count, std::function<void(GeneView<Gene>, std::mt19937&)> generator) {
+            std::mt19937& mt = RandomStream::engine();
+            std::vector<int> added;
+            added.reserve(count);
+            for(int i = 0; i < count; i++) {
+                int n = addUnevaluatedMember();
+                generator(getMutableGenes(n), mt);
+                added.push_back(n);
+            }
+            evaluateMembers(added);
+        }
+
+        /// @brief Evaluate members in batches, turning each batch's genomes
+        /// into phenotypes for ObjectiveBase::evaluateBatch(). Records are read
+        /// in file order
+        /// @param memberIndices Members to evaluate
+        /// @param bounded Evaluate under the objective's score bound, for new
+        /// children only
+        void evaluateMembers(const std::vector<int>& memberIndices, bool bounded=false) {
+            std::vector<int> indices = inFileOrder(memberIndices);
+            std::vector<std::shared_ptr<PhenotypeBase>> batch;
+            std::vector<PhenotypeBase*> batchPointers;
+            for(size_t start = 0; start < indices.size(); start += evaluationBatchSize) {
+                size_t end = std::min(indices.size(), start + evaluationBatchSize);
+                batch.clear();
+                batchPointers.clear();
+                for(size_t i = start; i < end; i++) {
+                    batch.push_back(materialise(indices[i]));
+                    batchPointers.push_back(batch.back().get());
+                }
+                std::vector<double> scores = objective->evaluateBatch(batchPointers, bounded);
+                for(size_t i = start; i < end; i++) members[indices[i]].score = scores[i - start];
+            }
+        }
+
+        /// @brief Build a phenotype holding a copy of member n's genome
+        std::shared_ptr<PhenotypeBase> materialise(int n) const {
+            GeneView<const Gene> genes = getGenes(n);
+            std::unique_ptr<RepresentationBase> representation = emptyRepresentation->emptyCopy();
+            if constexpr (std::is_same<Gene, double>::value) {
+                std::vector<double> copy(genes.begin(), genes.end());
+                representation->setDoubleVectorRepresentation(copy);
+            } else {
+                //Narrow index genes are widened here
+                std::vector<int> copy(genes.begin(), genes.end());
+                representation->setIntegerVectorRepresentation(copy);
+            }
+            std::shared_ptr<PhenotypeBase> phenotype = emptyPhenotype->emptyCopy();
+            phenotype->setRepresentation_NOEVALUATE(std::move(representation));
+            phenotype->setScore(members[n].score);
+            return phenotype;
+        }
+
+        /// @brief Sorts the members in the order best -> worst, only the
+        /// in-memory scores and slots move
+        void sort() {
+            std::sort(members.begin(), members.end(), [](const Member& a, const Member& b) {
+                return a.score < b.score;
+            });
+        }
+
+        /// @brief Keep the first n members, the records of the rest are reused
+        /// lowest slot first so new children are written in file order
+        void resizePopulation(int n) {
+            if(n >= static_cast<int>(members.size())) return;
+            for(size_t i = n; i < members.size(); i++) freeSlots.push_back(members[i].slot);
+            members.resize(n);
+            std::sort(freeSlots.begin(), freeSlots.end(), std::greater<int>());
+        }
+
+        /// @brief Rewrite the file so member i is stored in record i, after
+        /// which scanning members in order reads the file sequentially. Moves
+        /// every misplaced record once, using one record of scratch
+        void compact() {
+            int n = members.size();
+            //memberAt[slot] = member currently stored in slot, -1 if free
+            std::vector<int> memberAt(usedSlots, -1);
+            for(int i = 0; i < n; i++) memberAt[members[i].slot] = i;
+            std::vector<Gene> scratch(genomeLength);
+            for(int start = 0; start < n; start++) {
+                if(members[start].slot == start) continue;
+                //Save the record occupying start, then pull each member into
+                //the slot vacated by the previous move
+                int displaced = memberAt[start];
+                if(displaced != -1) std::copy(recordAt(start), recordAt(start) + genomeLength, scratch.begin());
+                int current = start;
+                while(true) {
+                    int source = members[current].slot;
+                    if(source == start) {
+                        std::copy(scratch.begin(), scratch.end(), recordAt(current));
+                        place(current, current, memberAt);
+                        break;
+                    }
+                    std::copy(recordAt(source), recordAt(source) + genomeLength, recordAt(current));
+                    place(current, current, memberAt);
+                    memberAt[source] = -1;
+                    if(source >= n) {
+                        //Chain left the target range, park the saved record in the freed slot
+                        if(displaced != -1) {
+                            std::copy(scratch.begin(), scratch.end(), recordAt(source));
+                            place(displaced, source, memberAt);
+                        }
+                        break;
+                    }
+                    current = source;
+                }
+            }
+            usedSlots = n;
+            freeSlots.clear();
+        }
+
+        /// @brief Ask the kernel to read member n's record ahead of use
+        void prefetch(int n) const {
+            size_t begin = static_cast<size_t>(members[n].slot) * recordBytes;
+            size_t alignedBegin = begin - begin % pageBytes;
+            madvise(reinterpret_cast<char*>(records) + alignedBegin, begin + recordBytes - alignedBegin, MADV_WILLNEED);
+        }
+
+        /// @brief Record slot of member n, members with lower slots are
+        /// earlier in the file
+        int getSlot(int n) const {return members[n].slot;}
+
+        /// @brief Copy of memberIndices sorted by record slot
+        std::vector<int> inFileOrder(const std::vector<int>& memberIndices) const {
+            std::vector<int> ordered = memberIndices;
+            std::sort(ordered.begin(), ordered.end(), [this](int a, int b) {
+                return members[a].slot < members[b].slot;
+            });
+            return ordered;
+        }
+
+        void reserveSelected(int n) {selected.reserve(n);}
+
+        void select(int n) {selected.push_back(n);}
+
+        void clearSelected() {selected.clear();}
+
+        std::vector<int> getSelectedIndices() {return selected;}
+
+        const std::unique_ptr<ObjectiveBase>& getObjective() const {return objective;}
+
+    private:
+        struct Member {
+            double score;
+            int slot;
+        };
+
+        std::string path;
+        int genomeLength;
+        int capacity;
+        std::shared_ptr<PhenotypeBase> emptyPhenotype;
+        std::unique_ptr<RepresentationBase> emptyRepresentation;
+        const std::unique_ptr<ObjectiveBase>& objective;
+        int evaluationBatchSize;
+        bool removeFile;
+        int fd = -1;
+        Gene* records = nullptr;
+        size_t recordBytes;
+        size_t mappedBytes;
+        size_t pageBytes;
+        int usedSlots = 0;
+        std::vector<int> freeSlots;
+        std::vector<Member> members;
+        std::vector<int> selected;
+
+        Gene* recordAt(int slot) {return records + static_cast<size_t>(slot) * genomeLength;}
+
+        void place(int member, int slot, std::vector<int>& memberAt) {
+            members[member].slot = slot;
+            memberAt[slot] = member;
+        }
+};
+
+namespace Selection {
+    /// @brief binaryTournamentSelection() for a MappedPopulation, only the
+    /// in-memory scores are read
+    template <typename Gene>
+    void binaryTournamentSelection(MappedPopulation<Gene>& population, int numToSelect, TerminationManager& terminationManager) {
+        if(terminationManager.checkTermination()) return;
+        population.clearSelected();
+        if(population.size() < 2) {
+            std::cerr << "binaryTournamentSelection:\ncannot run a tournament on fewer than two individuals\n";
+            exit(-1);
+        }
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_int_distribution<int> memberDist(0, population.size() - 1);
+        population.reserveSelected(numToSelect);
+        for(int i = 0; i < numToSelect; i++) {
+            int a = memberDist(mt);
+            int b = memberDist(mt);
+            population.select(population.getScore(b) < population.getScore(a) ? b : a);
+        }
+    }
+}
+
+namespace Variation {
+    /// @brief Crossover of the selected pairs of a MappedPopulation. Pairs are
+    /// bred in file order of their first parent with the records of the pair
+    /// prefetchDistance ahead requested from the kernel, children are written
+    /// straight into free records and evaluated in batches. The children are
+    /// left selected, as with the Population crossovers
+    /// @param kernel Callable (GeneView<const Gene> parent1, GeneView<const
+    /// Gene> parent2, GeneView<Gene> child1, GeneView<Gene> child2,
+    /// std::mt19937&), e.g. OrderedCrossoverKernel
+    /// @param prefetchDistance Pairs ahead whose records are prefetched
+    template <typename Gene, typename Kernel>
+    void mappedCrossover(MappedPopulation<Gene>& population, TerminationManager& terminationManager, Kernel kernel, double crossoverRate=0.8, int prefetchDistance=8) {
+        std::vector<int> selected = population.getSelectedIndices();
+        population.clearSelected();
+        if(crossoverRate < 0.000001) return;
+        if(selected.size() < 2) {
+            std::cerr << "Variation::mappedCrossover\nCan't have n < 2 for crossover\nExiting Program\n";
+            exit(-1);
+        }
+        if(terminationManager.checkTermination()) return;
+
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
+
+        std::vector<std::pair<int, int>> pairs;
+        for(size_t p = 0; p + 1 < selected.size(); p += 2) {
+            if(realDist(mt) <= crossoverRate) pairs.push_back(std::make_pair(selected[p], selected[p + 1]));
+        }
+        std::sort(pairs.begin(), pairs.end(), [&](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+            return population.getSlot(a.first) < population.getSlot(b.first);
+        });
+
+        std::vector<int> children;
+        children.reserve(2 * pairs.size());
+        for(size_t p = 0; p < pairs.size(); p++) {
+            if(p + prefetchDistance < pairs.size()) {
+                population.prefetch(pairs[p + prefetchDistance].first);
+                population.prefetch(pairs[p + prefetchDistance].second);
+            }
+            int child1 = population.addUnevaluatedMember();
+            int child2 = population.addUnevaluatedMember();
+            kernel(population.getGenes(pairs[p].first), population.getGenes(pairs[p].second), population.getMutableGenes(child1), population.getMutableGenes(child2), mt);
+            children.push_back(child1);
+            children.push_back(child2);
+        }
+        population.evaluateMembers(children, true);
+        for(int child : children) population.select(child);
+    }
+
+    /// @brief Mutation of the selected members of a MappedPopulation in place.
+    /// Members are visited in file order with prefetching, mutated members are
+    /// re-evaluated in batches
+    /// @param kernel Callable (GeneView<Gene> genes, std::mt19937&)
+    /// @param prefetchDistance Members ahead whose records are prefetched
+    template <typename Gene, typename Kernel>
+    void mappedMutation(MappedPopulation<Gene>& population, TerminationManager& terminationManager, Kernel kernel, double mutationRate=0.3, int prefetchDistance=16) {
+        if(mutationRate == 0) return;
+        if(mutationRate < 0 || mutationRate > 1) {
+            std::cerr << "mappedMutation\nMutation rate must be between [0,1], not " << mutationRate << "\n";
+            exit(-1);
+        }
+        if(terminationManager.checkTermination()) return;
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
+
+        std::vector<int> mutated;
+        for(int sel : population.getSelectedIndices()) {
+            if(realDist(mt) <= mutationRate) mutated.push_back(sel);
+        }
+        //A member selected twice is mutated once
+        mutated = population.inFileOrder(mutated);
+        mutated.erase(std::unique(mutated.begin(), mutated.end()), mutated.end());
+        for(size_t m = 0; m < mutated.size(); m++) {
+            if(m + prefetchDistance < mutated.size()) population.prefetch(mutated[m + prefetchDistance]);
+            kernel(population.getMutableGenes(mutated[m]), mt);
+        }
+        population.evaluateMembers(mutated);
+    }
+}
+
+namespace Reproduction {
+    /// @brief nElitism() for a MappedPopulation, the records of removed
+    /// members are reused by later children. Sets the objective's score bound
+    /// as nElitism() does
+    template <typename Gene>
+    void nElitism(MappedPopulation<Gene>& population, int n, TerminationManager& terminationManager) {
+        if(terminationManager.checkTermination()) return;
+        population.sort();
+        population.resizePopulation(std::min(population.size(), n));
+        const std::unique_ptr<ObjectiveBase>& objective = population.getObjective();
+        if(population.size() == n && n > 0) {
+            objective->setScoreBound(population.getScore(n - 1));
+        } else {
+            objective->clearScoreBound();
+        }
+    }
+}
+#endif
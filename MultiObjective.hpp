@@ -0,0 +1,274 @@
+#ifndef MULTIOBJECTIVE_HPP
+#define MULTIOBJECTIVE_HPP
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <map>
+#include <iterator>
+#include "Objective.hpp"
+#include "phenotype.hpp"
+
+/// @brief Base class for vector valued objectives. Implement fitnessFunctions()
+/// to write one value per objective (all minimised), the values are stored on
+/// the phenotype. The scalar score returned for compatibility is the sum of the
+/// objectives, NSGA2GeneticAlgorithm replaces it with a rank / crowding score
+/// and clears the score bound, so getScoreBound() is always infinity there
+class MultiObjectiveBase : public ObjectiveBase {
+    public:
+        MultiObjectiveBase(int numObjectives) : numObjectives(numObjectives) {}
+
+        virtual ~MultiObjectiveBase() {}
+
+        int getNumberOfObjectives() const {return numObjectives;}
+
+    protected:
+        /// @brief Compute every objective value of phenotype
+        /// @param phenotype Phenotype to evaluate
+        /// @param values Output array of getNumberOfObjectives() values
+        virtual void fitnessFunctions(PhenotypeBase& phenotype, double* values) = 0;
+
+        virtual double fitnessFunction(PhenotypeBase& phenotype) override final {
+            std::vector<double> values(numObjectives);
+            fitnessFunctions(phenotype, values.data());
+            phenotype.setObjectiveValues(values);
+            return std::accumulate(values.begin(), values.end(), 0.0);
+        }
+
+        int numObjectives;
+};
+
+namespace NonDominatedSorting {
+    /// @brief True if row a of the objective matrix Pareto dominates row b
+    bool dominates(const double* a, const double* b, int m) {
+        bool strictlyBetter = false;
+        for(int j = 0; j < m; j++) {
+            if(a[j] > b[j]) return false;
+            if(a[j] < b[j]) strictlyBetter = true;
+        }
+        return strictlyBetter;
+    }
+
+    /// @brief Divide and conquer non-dominated sort of Jensen, generalised by
+    /// Fortin et al. and Buzdalov and Shalyto. Rows are sorted
+    /// lexicographically and duplicates merged, so row a can only dominate row
+    /// b if it comes first and is no worse on objectives 1..m-1. Ranks are
+    /// found by recursively splitting on the median of the last objective
+    /// still considered: helperA() ranks a set against itself, helperB()
+    /// raises the ranks of one set from another whose ranks are final. Two
+    /// objectives reduce to a single sweep over a staircase of (value, rank),
+    /// giving O(N log^(M-1) N) for M objectives, O(N log N) for two
+    class DivideAndConquerSorter {
+        public:
+            /// @param objectives Row-major n x m matrix of minimised objective values
+            /// @param rows Matrix row of each point, lexicographically sorted
+            /// without duplicates
+            DivideAndConquerSorter(const std::vector<double>& objectives, int m, const std::vector<int>& rows)
+            : objectives(objectives), m(m), rows(rows), ranks(rows.size(), 0) {}
+
+            /// @return vector<int> front rank of each point, in the order of rows
+            std::vector<int> sort() {
+                std::vector<int> points(rows.size());
+                std::iota(points.begin(), points.end(), 0);
+                if(m == 1) return points;
+                helperA(points, m - 1);
+                return ranks;
+            }
+
+        private:
+            const std::vector<double>& objectives;
+            int m;
+            const std::vector<int>& rows;
+            std::vector<int> ranks;
+
+            double value(int point, int k) const {return objectives[static_cast<size_t>(rows[point]) * m + k];}
+
+            /// @brief True if point a is no worse than b on objectives 1..k
+            bool weaklyDominates(int a, int b, int k) const {
+                for(int j = 1; j <= k; j++) {
+                    if(value(a, j) > value(b, j)) return false;
+                }
+                return true;
+            }
+
+            void raise(int point, int dominator) {ranks[point] = std::max(ranks[point], ranks[dominator] + 1);}
+
+            /// @brief Median of objective k over both sets of points
+            double median(const std::vector<int>& a, const std::vector<int>& b, int k) const {
+                std::vector<double> values;
+                values.reserve(a.size() + b.size());
+                for(int point : a) values.push_back(value(point, k));
+                for(int point : b) values.push_back(value(point, k));
+                std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+                return values[values.size() / 2];
+            }
+
+            /// @brief Split points by objective k into less than, equal to and
+            /// greater than pivot, each keeping the order of points
+            void split(const std::vector<int>& points, int k, double pivot, std::vector<int>& less, std::vector<int>& equal, std::vector<int>& greater) const {
+                for(int point : points) {
+                    double v = value(point, k);
+                    if(v < pivot) {
+                        less.push_back(point);
+                    } else if(v == pivot) {
+                        equal.push_back(point);
+                    } else {
+                        greater.push_back(point);
+                    }
+                }
+            }
+
+            static std::vector<int> merge(const std::vector<int>& a, const std::vector<int>& b) {
+                std::vector<int> merged(a.size() + b.size());
+                std::merge(a.begin(), a.end(), b.begin(), b.end(), merged.begin());
+                return merged;
+            }
+
+            /// @brief Add (v, rank) to a staircase whose values and ranks both
+            /// strictly increase, dropping the entries it makes redundant
+            static void insertStair(std::map<double, int>& stair, double v, int rank) {
+                auto it = stair.upper_bound(v);
+                if(it != stair.begin() && std::prev(it)->second >= rank) return;
+                it = stair.lower_bound(v);
+                while(it != stair.end() && it->second <= rank) it = stair.erase(it);
+                stair[v] = rank;
+            }
+
+            /// @brief Highest rank in the staircase with value <= v, -1 if none
+            static int queryStair(const std::map<double, int>& stair, double v) {
+                auto it = stair.upper_bound(v);
+                return it == stair.begin() ? -1 : std::prev(it)->second;
+            }
+
+            /// @brief Rank points against each other on objectives 1..k, their
+            /// values of the objectives above k are equal
+            void helperA(const std::vector<int>& points, int k) {
+                if(points.size() < 2) return;
+                if(points.size() == 2) {
+                    if(weaklyDominates(points[0], points[1], k)) raise(points[1], points[0]);
+                    return;
+                }
+                if(k == 1) {
+                    std::map<double, int> stair;
+                    for(int point : points) {
+                        ranks[point] = std::max(ranks[point], queryStair(stair, value(point, 1)) + 1);
+                        insertStair(stair, value(point, 1), ranks[point]);
+                    }
+                    return;
+                }
+                auto bounds = std::minmax_element(points.begin(), points.end(), [&](int a, int b) {return value(a, k) < value(b, k);});
+                if(value(*bounds.first, k) == value(*bounds.second, k)) {
+                    helperA(points, k - 1);
+                    return;
+                }
+                std::vector<int> less, equal, greater;
+                split(points, k, median(points, {}, k), less, equal, greater);
+                helperA(less, k);
+                helperB(less, equal, k - 1);
+                helperA(equal, k - 1);
+                helperB(merge(less, equal), greater, k - 1);
+                helperA(greater, k);
+            }
+
+            /// @brief Raise the ranks of high from the final ranks of low on
+            /// objectives 1..k, every low point is no worse than every high
+            /// point on the objectives above k
+            void helperB(const std::vector<int>& low, const std::vector<int>& high, int k) {
+                if(low.empty() || high.empty()) return;
+                if(low.size() == 1 || high.size() == 1) {
+                    for(int h : high) {
+                        for(int l : low) {
+                            if(l < h && weaklyDominates(l, h, k)) raise(h, l);
+                        }
+                    }
+                    return;
+                }
+                if(k == 1) {
+                    std::map<double, int> stair;
+                    size_t next = 0;
+                    for(int h : high) {
+                        for(; next < low.size() && low[next] < h; next++) {
+                            insertStair(stair, value(low[next], 1), ranks[low[next]]);
+                        }
+                        ranks[h] = std::max(ranks[h], queryStair(stair, value(h, 1)) + 1);
+                    }
+                    return;
+                }
+                auto lowBounds = std::minmax_element(low.begin(), low.end(), [&](int a, int b) {return value(a, k) < value(b, k);});
+                auto highBounds = std::minmax_element(high.begin(), high.end(), [&](int a, int b) {return value(a, k) < value(b, k);});
+                if(value(*lowBounds.second, k) <= value(*highBounds.first, k)) {
+                    helperB(low, high, k - 1);
+                    return;
+                }
+                if(value(*lowBounds.first, k) > value(*highBounds.second, k)) return;
+                double pivot = median(low, high, k);
+                std::vector<int> lowLess, lowEqual, lowGreater, highLess, highEqual, highGreater;
+                split(low, k, pivot, lowLess, lowEqual, lowGreater);
+                split(high, k, pivot, highLess, highEqual, highGreater);
+                helperB(lowLess, highLess, k);
+                helperB(lowGreater, highGreater, k);
+                helperB(merge(lowLess, lowEqual), merge(highEqual, highGreater), k - 1);
+            }
+    };
+
+    /// @brief Front rank of every row, see DivideAndConquerSorter
+    /// @param objectives Row-major n x m matrix of minimised objective values
+    /// @param n Number of rows
+    /// @param m Number of objectives
+    /// @return vector<int> front rank of each row, 0 is the Pareto front
+    std::vector<int> sort(const std::vector<double>& objectives, int n, int m) {
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        auto row = [&](int i) {return objectives.data() + static_cast<size_t>(i) * m;};
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            return std::lexicographical_compare(row(a), row(a) + m, row(b), row(b) + m);
+        });
+
+        //Identical rows share a rank and do not dominate each other
+        std::vector<int> unique;
+        std::vector<int> uniqueOf(n);
+        for(int i = 0; i < n; i++) {
+            if(unique.empty() || !std::equal(row(order[i]), row(order[i]) + m, row(unique.back()))) unique.push_back(order[i]);
+            uniqueOf[i] = unique.size() - 1;
+        }
+
+        std::vector<int> uniqueRanks = DivideAndConquerSorter(objectives, m, unique).sort();
+        std::vector<int> ranks(n);
+        for(int i = 0; i < n; i++) ranks[order[i]] = uniqueRanks[uniqueOf[i]];
+        return ranks;
+    }
+
+    /// @brief Crowding distance of every row within its own front, boundary
+    /// rows of each objective get infinity
+    /// @param objectives Row-major n x m matrix of minimised objective values
+    /// @param ranks Front rank of each row from NonDominatedSorting::sort()
+    /// @return vector<double> crowding distance of each row
+    std::vector<double> crowdingDistance(const std::vector<double>& objectives, int n, int m, const std::vector<int>& ranks) {
+        std::vector<double> distance(n, 0.0);
+        if(n == 0) return distance;
+        int numFronts = *std::max_element(ranks.begin(), ranks.end()) + 1;
+        std::vector<std::vector<int>> fronts(numFronts);
+        for(int i = 0; i < n; i++) fronts[ranks[i]].push_back(i);
+
+        const double infinity = std::numeric_limits<double>::infinity();
+        for(std::vector<int>& front : fronts) {
+            int size = front.size();
+            for(int j = 0; j < m; j++) {
+                std::sort(front.begin(), front.end(), [&](int a, int b) {
+                    return objectives[static_cast<size_t>(a) * m + j] < objectives[static_cast<size_t>(b) * m + j];
+                });
+                double minValue = objectives[static_cast<size_t>(front.front()) * m + j];
+                double maxValue = objectives[static_cast<size_t>(front.back()) * m + j];
+                distance[front.front()] = infinity;
+                distance[front.back()] = infinity;
+                if(maxValue - minValue <= 0.0) continue;
+                for(int k = 1; k < size - 1; k++) {
+                    double gap = objectives[static_cast<size_t>(front[k + 1]) * m + j] - objectives[static_cast<size_t>(front[k - 1]) * m + j];
+                    distance[front[k]] += gap / (maxValue - minValue);
+                }
+            }
+        }
+        return distance;
+    }
+}
+#endif
@@ -1,6 +1,11 @@
 #ifndef MUTATION_HPP
 #define MUTATION_HPP
 #include <random>
+#include "TwoLevelTourRepresentation.hpp"
+#include "CompactPermutationRepresentation.hpp"
+#include "RealVariationKernels.hpp"
+#include "BitStringRepresentation.hpp"
+#include "RandomStream.hpp"
 
 class Population;
 
@@ -15,29 +20,27 @@ namespace Variation {
             std::cerr << "rotationToRight\nMutation rate must be between [0,1], not " << mutationRate << "\n";
             exit(-1);
         }
-        static bool seeded = false;
-        if(!seeded) {
-            time_t ct = time(NULL);
-            srand(ct);
-            seeded = true;
-        }
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
         int permutationSize = population[0].getRepresentationSize();
         const std::vector<int> selected = population.getSelectedIndices();
         population.clearSelected();
 
         for(int sel : selected) {
             if(terminationManager.checkTermination()) return;
-            double mutationProbability = double(rand()) / double(RAND_MAX);
+            double mutationProbability = realDist(mt);
             if(mutationRate < mutationProbability) continue;
             int i, j, k;
-            i = rand() % permutationSize;
-            j = rand() % permutationSize;
-            k = rand() % (permutationSize + 1);
+            i = std::uniform_int_distribution<int>(0, permutationSize - 1)(mt);
+            j = std::uniform_int_distribution<int>(0, permutationSize - 1)(mt);
+            k = std::uniform_int_distribution<int>(0, permutationSize)(mt);
             if(i == j) continue;
             
             const RepresentationBase& representation = population[sel].getRepresentation();
-            const std::vector<int>& permutation = representation.getIntegerVectorRepresentation();
-            std::vector<int> newPermutation = std::vector<int>(permutationSize, -1);
+            std::vector<int> scratch;
+            GeneView<const int> permutation = readIntegerGenes(representation, scratch);
+            GeneWriter<int> newGenes(representation, permutationSize);
+            GeneView<int> newPermutation = newGenes.genes();
             std::vector<int> partial;
             if(i <= j) {
                 int partialSize = abs(j - i) + 1;
@@ -75,12 +78,16 @@ namespace Variation {
                 }
             }
             const std::unique_ptr<ObjectiveBase>& objective = population.getObjective();
-            std::unique_ptr<RepresentationBase> newRepresentation = representation.emptyCopy();
-            newRepresentation->setIntegerVectorRepresentation(newPermutation);
-            population.getPopulationMember(sel).setRepresentation(std::move(newRepresentation), objective);
+            population.getPopulationMember(sel).setRepresentation(newGenes.release(), objective);
         }
     }
 
+    /// @brief Reverse a random segment of each selected member with
+    /// probability mutationRate. With a surrogate screen set on the population
+    /// the mutants are screened in one batch by
+    /// Population::evaluateAndReplaceMembers(), members whose mutant is not
+    /// chosen are left unchanged. Two level tours and
+    /// CompactPermutationRepresentation genes are reversed in place
     void twoOptSwap(Population& population, TerminationManager& terminationManager, double mutationRate=0.3) {
         if(mutationRate == 0) return;
         if(mutationRate < 0 || mutationRate > 1) {
@@ -91,20 +98,20 @@ namespace Variation {
         int chromosomeSize = population[0].getRepresentationSize();
         const std::vector<int> selected = population.getSelectedIndices();
 
-        static std::random_device rd;
-        static std::mt19937 mt(rd());
-        static std::uniform_int_distribution<int> intDist(0, chromosomeSize - 1);
-        static std::uniform_real_distribution<double> realDist(0.0, 1.0);
-
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_int_distribution<int> intDist(0, chromosomeSize - 1);
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
+        //With a surrogate screen mutants are built as copies and screened in one batch
+        bool screened = population.getSurrogate() != nullptr;
+        std::vector<int> mutatedIndices;
+        std::vector<std::shared_ptr<PhenotypeBase>> mutants;
 
         for(int sel : selected) {
-            if(terminationManager.checkTermination()) return;
+            if(terminationManager.checkTermination()) break;
             double mutationProbability = realDist(mt);
             if(mutationRate < mutationProbability) continue;
 
             const RepresentationBase& representation = population[sel].getRepresentation();
-            const std::vector<int>& permutation = representation.getIntegerVectorRepresentation();
-            std::vector<int> newPermutation = std::vector<int>(chromosomeSize);
 
             int v1, v2;
             do {
@@ -117,6 +124,52 @@ namespace Variation {
                 v2 = t;
             }
 
+            //Two level tours reverse [v1, v2] in place in O(sqrt(n)), without
+            //copying or flattening the tour
+            PhenotypeBase& member = population.getPopulationMember(sel);
+            if(TwoLevelTourRepresentation* tour = dynamic_cast<TwoLevelTourRepresentation*>(&member.getMutableRepresentation())) {
+                if(screened) {
+                    std::unique_ptr<RepresentationBase> copy = tour->deepCopy();
+                    TwoLevelTourRepresentation& copyTour = static_cast<TwoLevelTourRepresentation&>(*copy);
+                    copyTour.reverse(copyTour.cityAt(v1), copyTour.cityAt(v2));
+                    std::shared_ptr<PhenotypeBase> mutant = member.emptyCopy();
+                    mutant->setRepresentation_NOEVALUATE(std::move(copy));
+                    mutatedIndices.push_back(sel);
+                    mutants.push_back(mutant);
+                    continue;
+                }
+                tour->reverse(tour->cityAt(v1), tour->cityAt(v2));
+                member.reevaluate(population.getObjective());
+                continue;
+            }
+
+            //Compact permutations reverse [v1, v2] on their narrow genes, in
+            //place unless screened
+            auto reverseSegment = [v1, v2](auto& compact) {
+                auto genes = compact.getMutableGenes();
+                std::reverse(genes.begin() + v1, genes.begin() + v2 + 1);
+            };
+            if(screened) {
+                if(visitCompactPermutation(representation, [](const auto&) {})) {
+                    std::unique_ptr<RepresentationBase> copy = representation.deepCopy();
+                    if(visitCompactPermutation(*copy, reverseSegment)) {
+                        std::shared_ptr<PhenotypeBase> mutant = member.emptyCopy();
+                        mutant->setRepresentation_NOEVALUATE(std::move(copy));
+                        mutatedIndices.push_back(sel);
+                        mutants.push_back(mutant);
+                        continue;
+                    }
+                }
+            } else if(visitCompactPermutation(member.getMutableRepresentation(), reverseSegment)) {
+                member.reevaluate(population.getObjective());
+                continue;
+            }
+
+            std::vector<int> scratch;
+            GeneView<const int> permutation = readIntegerGenes(representation, scratch);
+            GeneWriter<int> newGenes(representation, chromosomeSize);
+            GeneView<int> newPermutation = newGenes.genes();
+
             //Fill first part of vector forwards
             for(int i = 0; i < v1; i++) {
                 newPermutation[i] = permutation[i];
@@ -130,14 +183,163 @@ namespace Variation {
                 newPermutation[i] = permutation[i];
             }
             
+            if(screened) {
+                std::shared_ptr<PhenotypeBase> mutant = member.emptyCopy();
+                mutant->setRepresentation_NOEVALUATE(newGenes.release());
+                mutatedIndices.push_back(sel);
+                mutants.push_back(mutant);
+                continue;
+            }
             const std::unique_ptr<ObjectiveBase>& objective = population.getObjective();
-            std::unique_ptr<RepresentationBase> newRepresentation = representation.emptyCopy();
-            newRepresentation->setIntegerVectorRepresentation(newPermutation);
-            population.getPopulationMember(sel).setRepresentation(std::move(newRepresentation), objective);
+            population.getPopulationMember(sel).setRepresentation(newGenes.release(), objective);
+
+        }
+        if(!mutants.empty()) population.evaluateAndReplaceMembers(mutatedIndices, mutants);
+
+    }
 
+    /// @brief Shared gather / kernel / scatter driver for the real-coded
+    /// mutations, mutated members are copied into one contiguous matrix so the
+    /// kernel runs over the whole batch at once
+    /// @param kernel Callable (double* genes, int rows, int dimensions, std::mt19937& mt)
+    template <typename Kernel>
+    void mutateRealBatch(Population& population, TerminationManager& terminationManager, const std::vector<double>& lowerBounds, const std::vector<double>& upperBounds, double mutationRate, Kernels::BoundHandling boundHandling, const char* operatorName, Kernel kernel) {
+        if(mutationRate == 0) return;
+        if(mutationRate < 0 || mutationRate > 1) {
+            std::cerr << operatorName << "\nMutation rate must be between [0,1], not " << mutationRate << "\n";
+            exit(-1);
         }
+        int dimensions = population[0].getRepresentationSize();
+        if(static_cast<int>(lowerBounds.size()) != dimensions || static_cast<int>(upperBounds.size()) != dimensions) {
+            std::cerr << operatorName << "\nBounds must have one entry per gene\nExiting Program\n";
+            exit(-1);
+        }
+        const std::vector<int> selected = population.getSelectedIndices();
+
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
 
+        std::vector<int> mutated;
+        for(int sel : selected) {
+            if(realDist(mt) <= mutationRate) mutated.push_back(sel);
+        }
+        int rows = mutated.size();
+        if(rows == 0) return;
 
+        thread_local std::vector<double> genes;
+        genes.resize(static_cast<size_t>(rows) * dimensions);
+        std::vector<double> memberScratch;
+        for(int r = 0; r < rows; r++) {
+            GeneView<const double> memberGenes = readDoubleGenes(population[mutated[r]].getRepresentation(), memberScratch);
+            std::copy(memberGenes.begin(), memberGenes.end(), genes.begin() + static_cast<size_t>(r) * dimensions);
+        }
+
+        kernel(genes.data(), rows, dimensions, mt);
+        Kernels::applyBounds(genes.data(), lowerBounds.data(), upperBounds.data(), rows, dimensions, boundHandling);
+
+        const std::unique_ptr<ObjectiveBase>& objective = population.getObjective();
+        for(int r = 0; r < rows; r++) {
+            if(terminationManager.checkTermination()) return;
+            GeneWriter<double> newGenes(population[mutated[r]].getRepresentation(), dimensions);
+            std::copy(genes.begin() + static_cast<size_t>(r) * dimensions, genes.begin() + static_cast<size_t>(r + 1) * dimensions, newGenes.genes().begin());
+            population.getPopulationMember(mutated[r]).setRepresentation(newGenes.release(), objective);
+        }
+    }
+
+    /// @brief Polynomial mutation for real-valued representations
+    /// @param mutationRate Probability that a selected member is mutated
+    /// @param distributionIndex Larger values give smaller perturbations
+    /// @param geneMutationRate Probability each gene of a mutated member is
+    /// perturbed, defaults to 1 / number of genes
+    void polynomialMutation(Population& population, TerminationManager& terminationManager, const std::vector<double>& lowerBounds, const std::vector<double>& upperBounds, double mutationRate=0.3, double distributionIndex=20.0, double geneMutationRate=-1, Kernels::BoundHandling boundHandling=Kernels::BoundHandling::Clamp) {
+        mutateRealBatch(population, terminationManager, lowerBounds, upperBounds, mutationRate, boundHandling, "polynomialMutation",
+            [&](double* genes, int rows, int dimensions, std::mt19937& mt) {
+                thread_local std::vector<double> draws, mask, range;
+                size_t matrixSize = static_cast<size_t>(rows) * dimensions;
+                draws.resize(matrixSize);
+                mask.resize(matrixSize);
+                range.resize(dimensions);
+                for(int d = 0; d < dimensions; d++) range[d] = upperBounds[d] - lowerBounds[d];
+                Kernels::fillUniform(draws.data(), matrixSize, mt);
+                Kernels::fillUniform(mask.data(), matrixSize, mt);
+                double geneRate = geneMutationRate < 0 ? 1.0 / dimensions : geneMutationRate;
+                Kernels::polynomialMutation(genes, draws.data(), mask.data(), range.data(), rows, dimensions, geneRate, distributionIndex);
+            });
+    }
+
+    /// @brief Gaussian mutation for real-valued representations
+    /// @param mutationRate Probability that a selected member is mutated
+    /// @param sigma Standard deviation as a fraction of each gene's bound width
+    /// @param geneMutationRate Probability each gene of a mutated member is
+    /// perturbed, defaults to 1 / number of genes
+    void gaussianMutation(Population& population, TerminationManager& terminationManager, const std::vector<double>& lowerBounds, const std::vector<double>& upperBounds, double mutationRate=0.3, double sigma=0.1, double geneMutationRate=-1, Kernels::BoundHandling boundHandling=Kernels::BoundHandling::Clamp) {
+        mutateRealBatch(population, terminationManager, lowerBounds, upperBounds, mutationRate, boundHandling, "gaussianMutation",
+            [&](double* genes, int rows, int dimensions, std::mt19937& mt) {
+                thread_local std::vector<double> draws, mask, range;
+                size_t matrixSize = static_cast<size_t>(rows) * dimensions;
+                draws.resize(matrixSize);
+                mask.resize(matrixSize);
+                range.resize(dimensions);
+                for(int d = 0; d < dimensions; d++) range[d] = upperBounds[d] - lowerBounds[d];
+                Kernels::fillNormal(draws.data(), matrixSize, mt);
+                Kernels::fillUniform(mask.data(), matrixSize, mt);
+                double geneRate = geneMutationRate < 0 ? 1.0 / dimensions : geneMutationRate;
+                Kernels::gaussianMutation(genes, draws.data(), mask.data(), range.data(), rows, dimensions, geneRate, sigma);
+            });
+    }
+
+    /// @brief Bit flip mutation for BitStringRepresentation. Rather than
+    /// drawing a random number per bit, the gap to the next flipped bit is drawn
+    /// from a geometric distribution so the cost scales with the number of
+    /// flips, not the string length. Members where no bit flips are not
+    /// re-evaluated
+    /// @param mutationRate Probability that a selected member is mutated
+    /// @param bitFlipRate Probability each bit is flipped, defaults to 1 / number of bits
+    void bitFlipMutation(Population& population, TerminationManager& terminationManager, double mutationRate=0.3, double bitFlipRate=-1) {
+        if(mutationRate == 0) return;
+        if(mutationRate < 0 || mutationRate > 1) {
+            std::cerr << "bitFlipMutation\nMutation rate must be between [0,1], not " << mutationRate << "\n";
+            exit(-1);
+        }
+        int numBits = population[0].getRepresentationSize();
+        double flipRate = bitFlipRate < 0 ? 1.0 / numBits : bitFlipRate;
+        if(flipRate <= 0) return;
+        const std::vector<int> selected = population.getSelectedIndices();
+
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_real_distribution<double> realDist(0.0, 1.0);
+        //Geometric skips drawn by inversion, log1p keeps tiny rates accurate
+        //where std::geometric_distribution breaks down. At flipRate >= 1
+        //every bit flips, skips are clamped to numBits so position cannot
+        //overflow
+        bool flipAll = flipRate >= 1.0;
+        double logKeep = flipAll ? -1.0 : std::log1p(-flipRate);
+        auto nextSkip = [&]() -> long long {
+            if(flipAll) return 0;
+            double skip = std::floor(std::log(1.0 - realDist(mt)) / logKeep);
+            return skip < numBits ? static_cast<long long>(skip) : numBits;
+        };
+
+        for(int sel : selected) {
+            if(terminationManager.checkTermination()) return;
+            double mutationProbability = realDist(mt);
+            if(mutationRate < mutationProbability) continue;
+
+            const BitStringRepresentation* bits = dynamic_cast<const BitStringRepresentation*>(&population[sel].getRepresentation());
+            if(!bits) {
+                std::cerr << "bitFlipMutation\nPopulation members must use BitStringRepresentation\nExiting Program\n";
+                exit(-1);
+            }
+            long long position = nextSkip();
+            if(position >= numBits) continue;
+            std::unique_ptr<RepresentationBase> newRepresentation = bits->deepCopy();
+            BitStringRepresentation* newBits = static_cast<BitStringRepresentation*>(newRepresentation.get());
+            while(position < numBits) {
+                newBits->flipBit(position);
+                position += 1 + nextSkip();
+            }
+            population.getPopulationMember(sel).setRepresentation(std::move(newRepresentation), population.getObjective());
+        }
     }
 }
 #endif
\ No newline at end of file
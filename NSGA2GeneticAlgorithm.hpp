@@ -0,0 +1,104 @@
+#ifndef NSGA2GENETICALGORITHM_HPP
+#define NSGA2GENETICALGORITHM_HPP
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include "GeneticAlgorithm.hpp"
+#include "MultiObjective.hpp"
+#include "Selection.hpp"
+#include "Reproduction.hpp"
+
+/// @brief NSGA-II style multi-objective genetic algorithm. Before selection
+/// and before truncation the population's objective values are packed into one
+/// contiguous matrix, non-dominated sorted and given crowding distances. Each
+/// member's score is then set to rank + 1 / (2 + crowding distance), so the
+/// ordinary score based Population::sort(), Selection and Reproduction
+/// functions implement NSGA-II's crowded comparison. Implement variation() to
+/// apply Variation:: operators to the selected members. Children are never
+/// evaluated under a score bound, see ObjectiveBase::setScoreBound().
+/// getBestScore(), the convergence curve and any stagnation monitor track the
+/// smallest sum of objective values instead of the rank / crowding score.
+class NSGA2GeneticAlgorithm : public GeneticAlgorithm {
+    public:
+        /// @param populationSize Number of members kept after each generation
+        NSGA2GeneticAlgorithm(std::shared_ptr<PhenotypeBase> emptyPhenotype, std::vector<std::unique_ptr<RepresentationBase>> representations, std::unique_ptr<MultiObjectiveBase> objective, int populationSize)
+        : GeneticAlgorithm(emptyPhenotype, std::move(representations), std::unique_ptr<ObjectiveBase>(objective.release())), populationSize(populationSize) {
+            numObjectives = static_cast<MultiObjectiveBase*>(this->objective.get())->getNumberOfObjectives();
+        }
+
+        /// @brief For objectives that are not a MultiObjectiveBase themselves but
+        /// set numObjectives objective values on every phenotype they evaluate,
+        /// e.g. a ProcessPoolObjective whose workers build MultiObjectiveBase objectives
+        /// @param numObjectives Number of objective values set on each phenotype
+        /// @param populationSize Number of members kept after each generation
+        NSGA2GeneticAlgorithm(std::shared_ptr<PhenotypeBase> emptyPhenotype, std::vector<std::unique_ptr<RepresentationBase>> representations, std::unique_ptr<ObjectiveBase> objective, int numObjectives, int populationSize)
+        : GeneticAlgorithm(emptyPhenotype, std::move(representations), std::move(objective)), populationSize(populationSize), numObjectives(numObjectives) {}
+
+        /// @brief Copies of the current rank 0 (non-dominated) members
+        /// @return vector of phenotypes on the Pareto front
+        std::vector<std::shared_ptr<PhenotypeBase>> getParetoFront() {
+            rankPopulation();
+            std::vector<std::shared_ptr<PhenotypeBase>> front;
+            for(int i = 0; i < population->size(); i++) {
+                if((*population)[i].getScore() < 1.0) front.push_back((*population)[i].deepCopy());
+            }
+            return front;
+        }
+
+    protected:
+        /// @brief Apply variation operators to the selected members
+        virtual void variation() = 0;
+
+        virtual void geneticAlgorithm() override {
+            rankPopulation();
+            Selection::binaryTournamentSelection(*population, populationSize, terminationManager);
+            variation();
+            rankPopulation();
+            Reproduction::nElitism(*population, populationSize, terminationManager);
+            //The bound nElitism sets is a rank / crowding score, not comparable
+            //with objective values, so children are always evaluated in full
+            objective->clearScoreBound();
+        }
+
+        /// @brief Smallest sum of objective values in the population. Rank /
+        /// crowding scores are relative to each generation, front 0's boundary
+        /// members always score 0, so they say nothing about progress
+        virtual double progressScore() const override {
+            double best = std::numeric_limits<double>::infinity();
+            for(int i = 0; i < population->size(); i++) {
+                const std::vector<double>& values = (*population)[i].getObjectiveValues();
+                best = std::min(best, std::accumulate(values.begin(), values.end(), 0.0));
+            }
+            return best;
+        }
+
+        /// @brief Non-dominated sort the population and write the crowded
+        /// comparison score into every member
+        void rankPopulation() {
+            int n = population->size();
+            objectiveMatrix.resize(static_cast<size_t>(n) * numObjectives);
+            for(int i = 0; i < n; i++) {
+                const std::vector<double>& values = (*population)[i].getObjectiveValues();
+                if(static_cast<int>(values.size()) != numObjectives) {
+                    std::cerr << "NSGA2GeneticAlgorithm::rankPopulation\nMember has " << values.size() << " objective values, expected " << numObjectives << "\nExiting Program\n";
+                    exit(-1);
+                }
+                std::copy(values.begin(), values.end(), objectiveMatrix.begin() + static_cast<size_t>(i) * numObjectives);
+            }
+            std::vector<int> ranks = NonDominatedSorting::sort(objectiveMatrix, n, numObjectives);
+            std::vector<double> crowding = NonDominatedSorting::crowdingDistance(objectiveMatrix, n, numObjectives, ranks);
+            for(int i = 0; i < n; i++) {
+                double crowdingTerm = std::isinf(crowding[i]) ? 0.0 : 1.0 / (2.0 + crowding[i]);
+                population->getPopulationMember(i).setScore(ranks[i] + crowdingTerm);
+            }
+        }
+
+        int populationSize;
+        int numObjectives;
+
+    private:
+        std::vector<double> objectiveMatrix;
+};
+#endif
@@ -1,24 +1,251 @@
 #ifndef OBJECTIVE_HPP
 #define OBJECTIVE_HPP
+#include <vector>
+#include <future>
+#include <thread>
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
 
 class PhenotypeBase;
 
+/// @brief Fixed set of threads running the evaluations queued by
+/// ObjectiveBase::evaluateAsync(), so at most numThreads run at once however
+/// many are in flight
+class EvaluationThreadPool {
+    public:
+        explicit EvaluationThreadPool(int numThreads) {
+            for(int t = 0; t < numThreads; t++) {
+                threads.emplace_back(&EvaluationThreadPool::work, this);
+            }
+        }
+
+        /// @brief Waits for the running evaluations, queued ones are dropped
+        /// and their futures throw std::future_error
+        ~EvaluationThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+                queue.clear();
+            }
+            ready.notify_all();
+            for(std::thread& thread : threads) thread.join();
+        }
+
+        EvaluationThreadPool(const EvaluationThreadPool&) = delete;
+        EvaluationThreadPool& operator=(const EvaluationThreadPool&) = delete;
+
+        std::future<double> submit(std::function<double()> evaluation) {
+            std::shared_ptr<std::packaged_task<double()>> task = std::make_shared<std::packaged_task<double()>>(std::move(evaluation));
+            std::future<double> score = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(task);
+            }
+            ready.notify_one();
+            return score;
+        }
+
+    private:
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<std::shared_ptr<std::packaged_task<double()>>> queue;
+        bool stopping = false;
+
+        void work() {
+            while(true) {
+                std::shared_ptr<std::packaged_task<double()>> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [this]() {return stopping || !queue.empty();});
+                    if(stopping) return;
+                    task = queue.front();
+                    queue.pop_front();
+                }
+                (*task)();
+            }
+        }
+};
+
 class ObjectiveBase {
     public:
+        /// @brief Score returned by an evaluation abandoned because it would
+        /// exceed the score bound. Sorts after every real score
+        static constexpr double rejectedScore = std::numeric_limits<double>::infinity();
+
+        ObjectiveBase() {}
+
+        ObjectiveBase(const ObjectiveBase& other) : fitnessFunctionCallCount(other.fitnessFunctionCallCount), abortedCallCount(other.abortedCallCount.load()), scoreBound(other.scoreBound.load()) {}
+
+        ObjectiveBase& operator=(const ObjectiveBase& other) {
+            fitnessFunctionCallCount = other.fitnessFunctionCallCount;
+            abortedCallCount = other.abortedCallCount.load();
+            scoreBound = other.scoreBound.load();
+            return *this;
+        }
+
         /// @brief Virtual destructor of abstract base ObjectiveBase class
         virtual ~ObjectiveBase() {}
-        virtual double evaluate(PhenotypeBase& phenotype) final {
+        /// @param phenotype Phenotype to evaluate
+        /// @param bounded Evaluate under the score bound, only for new children
+        /// which are discarded when worse than it, see setScoreBound()
+        virtual double evaluate(PhenotypeBase& phenotype, bool bounded=false) final {
             incrementFitnessFunctionCallCount();
-            return fitnessFunction(phenotype);
+            ScoreBoundScope scope(bounded ? scoreBound.load() : noScoreBound);
+            double score = fitnessFunction(phenotype);
+            if(isRejected(score)) abortedCallCount++;
+            if(!bounded) raiseScoreBound(score);
+            return score;
         }
+        /// @brief Evaluate several phenotypes in one call, counts one fitness
+        /// function call per phenotype. Objectives able to evaluate in parallel
+        /// or out of process override fitnessFunctionBatch()
+        /// @param phenotypes Phenotypes to evaluate
+        /// @param bounded Evaluate under the score bound, only for new children
+        /// @return vector<double> of scores in the same order as phenotypes
+        virtual std::vector<double> evaluateBatch(const std::vector<PhenotypeBase*>& phenotypes, bool bounded=false) final {
+            fitnessFunctionCallCount += phenotypes.size();
+            std::vector<double> scores(phenotypes.size());
+            ScoreBoundScope scope(bounded ? scoreBound.load() : noScoreBound);
+            fitnessFunctionBatch(phenotypes, scores);
+            abortedCallCount += std::count_if(scores.begin(), scores.end(), isRejected);
+            if(!bounded && !scores.empty()) raiseScoreBound(*std::max_element(scores.begin(), scores.end()));
+            return scores;
+        }
+        /// @brief Start evaluating a phenotype without waiting for the score,
+        /// counts as one fitness function call immediately. Queued on the
+        /// objective's pool of hardware concurrency threads when isThreadSafe()
+        /// is true, otherwise evaluation is deferred until the future is waited
+        /// on. Wait on every future before destroying the objective
+        /// @param phenotype Phenotype to evaluate, must outlive the evaluation
+        /// @param bounded Evaluate under the score bound current at this call,
+        /// only for new children
+        /// @return std::future<double> of the score
+        virtual std::future<double> evaluateAsync(PhenotypeBase& phenotype, bool bounded=false) final {
+            incrementFitnessFunctionCallCount();
+            ScoreBoundScope scope(bounded ? scoreBound.load() : noScoreBound);
+            return fitnessFunctionAsync(phenotype);
+        }
+        /// @brief Override to return true if fitnessFunction() can safely run
+        /// on several threads at once
+        virtual bool isThreadSafe() const {return false;}
         int getCallCount() const {
             return fitnessFunctionCallCount;
         } 
+
+        /// @brief Number of calls, included in getCallCount(), that returned
+        /// rejectedScore because they exceeded the score bound
+        int getAbortedCallCount() const {return abortedCallCount;}
+
+        /// @brief Upper bound on the scores still of interest, e.g. the worst
+        /// survivor's score, set by Reproduction::nElitism(). It applies only
+        /// to evaluations requested with bounded = true, which the built-in
+        /// operators use for new children a truncation would discard when
+        /// worse than the bound. Re-scores of existing members, e.g. after a
+        /// mutation or a reseed, always run in full and raise the bound to
+        /// their score by raiseScoreBound(), as a member that got worse lowers
+        /// the score a child needs to survive. Objectives that accumulate their
+        /// score, like tour length, may compare partial sums with
+        /// getScoreBound() and return rejectedScore once it is exceeded.
+        /// Objectives that never check it are unaffected
+        void setScoreBound(double scoreBound) {this->scoreBound = scoreBound;}
+
+        /// @brief Remove the score bound, every evaluation runs in full
+        void clearScoreBound() {scoreBound = noScoreBound;}
+
+        /// @brief Raise the score bound to score if it is lower, no effect when
+        /// no bound is set. Called by evaluate() and evaluateBatch() for full
+        /// evaluations, call it for members re-scored any other way
+        void raiseScoreBound(double score) {
+            double bound = scoreBound.load();
+            while(score > bound && !scoreBound.compare_exchange_weak(bound, score)) {}
+        }
+
+        /// @brief Score bound of the evaluation running on this thread, to be
+        /// read from fitnessFunction(). Infinity for evaluations that must
+        /// run in full or when no bound is set
+        double getScoreBound() const {return activeScoreBound();}
+
+        static bool isRejected(double score) {return score == rejectedScore;}
     protected:
         void incrementFitnessFunctionCallCount() {
             fitnessFunctionCallCount++;
         }
         virtual double fitnessFunction(PhenotypeBase& phenotype) = 0;
+        virtual std::future<double> fitnessFunctionAsync(PhenotypeBase& phenotype) {
+            double bound = getScoreBound();
+            auto evaluation = [this, &phenotype, bound]() {
+                ScoreBoundScope scope(bound);
+                double score = fitnessFunction(phenotype);
+                if(isRejected(score)) abortedCallCount++;
+                return score;
+            };
+            if(!isThreadSafe()) return std::async(std::launch::deferred, evaluation);
+            return asyncPool().submit(evaluation);
+        }
+        /// @brief Pool running evaluateAsync(), started on first use
+        EvaluationThreadPool& asyncPool() {
+            std::lock_guard<std::mutex> lock(asyncPoolMutex);
+            if(!asyncEvaluationPool) {
+                asyncEvaluationPool = std::make_unique<EvaluationThreadPool>(std::max(1u, std::thread::hardware_concurrency()));
+            }
+            return *asyncEvaluationPool;
+        }
+        /// @brief Default batch evaluation, split into contiguous slices over
+        /// the hardware threads when isThreadSafe() is true, otherwise serial
+        virtual void fitnessFunctionBatch(const std::vector<PhenotypeBase*>& phenotypes, std::vector<double>& scores) {
+            int n = phenotypes.size();
+            int numThreads = isThreadSafe() ? std::min<int>(n, std::max(1u, std::thread::hardware_concurrency())) : 1;
+            if(numThreads <= 1) {
+                for(int i = 0; i < n; i++) {
+                    scores[i] = fitnessFunction(*phenotypes[i]);
+                }
+                return;
+            }
+            std::vector<std::thread> threads;
+            double bound = getScoreBound();
+            for(int t = 0; t < numThreads; t++) {
+                threads.emplace_back([this, &phenotypes, &scores, t, n, numThreads, bound]() {
+                    ScoreBoundScope scope(bound);
+                    for(int i = t * n / numThreads; i < (t + 1) * n / numThreads; i++) {
+                        scores[i] = fitnessFunction(*phenotypes[i]);
+                    }
+                });
+            }
+            for(std::thread& thread : threads) thread.join();
+        }
         int fitnessFunctionCallCount = 0;
+        //Atomic as asynchronous evaluations may update or read them from other threads
+        std::atomic<int> abortedCallCount{0};
+        std::atomic<double> scoreBound{std::numeric_limits<double>::infinity()};
+
+        /// @brief Sets the score bound seen by getScoreBound() on this thread
+        /// for its lifetime, restoring the previous one afterwards
+        class ScoreBoundScope {
+            public:
+                explicit ScoreBoundScope(double bound) : previous(activeScoreBound()) {activeScoreBound() = bound;}
+                ~ScoreBoundScope() {activeScoreBound() = previous;}
+                ScoreBoundScope(const ScoreBoundScope&) = delete;
+                ScoreBoundScope& operator=(const ScoreBoundScope&) = delete;
+            private:
+                double previous;
+        };
+    private:
+        static constexpr double noScoreBound = std::numeric_limits<double>::infinity();
+
+        static double& activeScoreBound() {
+            thread_local double bound = noScoreBound;
+            return bound;
+        }
+
+        //Not copied with the objective, each copy starts its own
+        std::mutex asyncPoolMutex;
+        std::unique_ptr<EvaluationThreadPool> asyncEvaluationPool;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,133 @@
+#ifndef PIPELINEDGENETICALGORITHM_HPP
+#define PIPELINEDGENETICALGORITHM_HPP
+#include <list>
+#include <future>
+#include <chrono>
+#include <random>
+#include <thread>
+#include "GeneticAlgorithm.hpp"
+#include "Reproduction.hpp"
+#include "RandomStream.hpp"
+
+/// @brief Genetic algorithm whose evaluations run asynchronously through
+/// ObjectiveBase::evaluateAsync(). Children are bred one at a time from the
+/// members that already have scores and submitted for evaluation, up to
+/// maxInFlight at once. A generation ends once offspringPerGeneration children
+/// have been submitted: finished children are merged and the population is
+/// truncated to survivorCount, but children still being evaluated are not
+/// waited for. They are merged into whichever later generation they finish
+/// in, so breeding never stalls behind the slowest evaluation. Once a
+/// termination flag fires the children still in flight are waited for and
+/// merged, their calls have already been counted. The objective should return
+/// true from isThreadSafe(), otherwise evaluations are deferred and run
+/// serially when collected.
+class PipelinedGeneticAlgorithm : public GeneticAlgorithm {
+    public:
+        /// @param survivorCount Population size kept after each generation
+        /// @param offspringPerGeneration Children submitted per generation
+        /// @param maxInFlight Maximum evaluations running at once, defaults to
+        /// twice the hardware concurrency
+        PipelinedGeneticAlgorithm(std::shared_ptr<PhenotypeBase> emptyPhenotype, std::vector<std::unique_ptr<RepresentationBase>> representations, std::unique_ptr<ObjectiveBase> objective, int survivorCount, int offspringPerGeneration, int maxInFlight=-1)
+        : GeneticAlgorithm(emptyPhenotype, std::move(representations), std::move(objective)), emptyPhenotype(emptyPhenotype), survivorCount(survivorCount), offspringPerGeneration(offspringPerGeneration), maxInFlight(maxInFlight) {
+            if(this->maxInFlight < 1) this->maxInFlight = 2 * std::max(1u, std::thread::hardware_concurrency());
+            mt.seed(RandomStream::engine()());
+        }
+
+        /// @brief Waits for evaluations still running, e.g. after runUntil()
+        virtual ~PipelinedGeneticAlgorithm() {
+            for(PendingChild& pending : inFlight) pending.score.wait();
+        }
+
+        /// @brief Number of evaluations currently running
+        int getInFlightCount() const {return inFlight.size();}
+
+        /// @brief Number of children merged in a later generation than the one
+        /// that bred them, i.e. evaluations the pipeline did not wait for
+        int getLateMergeCount() const {return lateMergeCount;}
+
+    protected:
+        /// @brief Breed one child from the scored population
+        /// @param population Members with scores, sorted best -> worst at the
+        /// start of each generation
+        /// @param mt Random engine owned by the algorithm
+        /// @return Representation of the child, it is evaluated asynchronously
+        virtual std::unique_ptr<RepresentationBase> breedChild(const Population& population, std::mt19937& mt) = 0;
+
+        virtual void geneticAlgorithm() override {
+            generation++;
+            bool terminating = false;
+            for(int submitted = 0; submitted < offspringPerGeneration; submitted++) {
+                terminating = terminationManager.checkTermination();
+                if(terminating) break;
+                collectFinished();
+                while(static_cast<int>(inFlight.size()) >= maxInFlight) {
+                    if(collectFinished() == 0) waitForOldest();
+                }
+                submit(breedChild(*population, mt));
+            }
+            //The last generation merges every child still in flight
+            if(terminating || terminationManager.checkTermination()) {
+                collectAll();
+            } else {
+                collectFinished();
+            }
+            Reproduction::nElitism(*population, survivorCount, terminationManager);
+        }
+
+    private:
+        struct PendingChild {
+            std::shared_ptr<PhenotypeBase> child;
+            std::future<double> score;
+            int generation;
+        };
+
+        std::shared_ptr<PhenotypeBase> emptyPhenotype;
+        int survivorCount;
+        int offspringPerGeneration;
+        int maxInFlight;
+        std::mt19937 mt;
+        std::list<PendingChild> inFlight;
+        int generation = 0;
+        int lateMergeCount = 0;
+
+        void submit(std::unique_ptr<RepresentationBase> representation) {
+            std::shared_ptr<PhenotypeBase> child = emptyPhenotype->emptyCopy();
+            child->setRepresentation_NOEVALUATE(std::move(representation));
+            std::future<double> score = objective->evaluateAsync(*child, true);
+            inFlight.push_back(PendingChild{child, std::move(score), generation});
+        }
+
+        /// @brief Merge every child whose score is ready into the population
+        /// @return Number of children merged
+        int collectFinished() {
+            int collected = 0;
+            for(auto it = inFlight.begin(); it != inFlight.end();) {
+                if(it->score.wait_for(std::chrono::seconds(0)) == std::future_status::timeout) {
+                    ++it;
+                    continue;
+                }
+                //Deferred evaluations run here
+                it->child->setScore(it->score.get());
+                if(it->generation < generation) lateMergeCount++;
+                population->addPopulationMember(it->child);
+                it = inFlight.erase(it);
+                collected++;
+            }
+            return collected;
+        }
+
+        /// @brief Block until the oldest child's score is ready
+        void waitForOldest() {
+            if(inFlight.empty()) return;
+            inFlight.front().score.wait();
+        }
+
+        /// @brief Wait for and merge every child still in flight
+        void collectAll() {
+            while(!inFlight.empty()) {
+                waitForOldest();
+                collectFinished();
+            }
+        }
+};
+#endif
@@ -6,8 +6,10 @@
 #include <unordered_set>
 #include <string>
 #include <memory>
+#include <numeric>
 #include <type_traits>
 #include "CheckHashable.hpp"
+#include "Surrogate.hpp"
 
 #if defined(__GNUC__) || defined(__clang__)
     #include <cxxabi.h>
@@ -23,10 +25,22 @@ class Population {
         Population(std::vector<std::shared_ptr<PhenotypeBase>> population, std::unique_ptr<ObjectiveBase>& objective) : population(population), objective(objective) {}
 
         Population(std::shared_ptr<PhenotypeBase> emptyPhenotype, std::vector<std::unique_ptr<RepresentationBase>> representations, std::unique_ptr<ObjectiveBase>& objective) : objective(objective) {
+            if(!objective) {
+                std::cerr << "In Population(std::shared_ptr<PhenotypeBase> emptyPhenotype, std::vector<std::unique_ptr<RepresentationBase>> representations, std::unique_ptr<ObjectiveBase>& objective)\n";
+                std::cerr << "Could not construct population because objective pointer is nullptr\nExiting program\n";
+                exit(0);
+            }
+            //Initial members are evaluated as one batch
+            std::vector<PhenotypeBase*> newMembers;
             for(auto& representation : representations) {
                 std::shared_ptr<PhenotypeBase> newMember = emptyPhenotype->emptyCopy();
-                newMember->setRepresentation(std::move(representation), objective);
+                newMember->setRepresentation_NOEVALUATE(std::move(representation));
                 addPopulationMember(newMember);
+                newMembers.push_back(newMember.get());
+            }
+            std::vector<double> scores = objective->evaluateBatch(newMembers);
+            for(size_t i = 0; i < newMembers.size(); i++) {
+                newMembers[i]->setScore(scores[i]);
             }
         } 
 
@@ -82,6 +96,54 @@ class Population {
             population.push_back(member);
         }
 
+        /// @brief Append several members in one pass, optionally selecting them
+        /// @param members Members to append, in order
+        /// @param selectAdded Add the new members' indices to the selected vector
+        void addPopulationMembers(const std::vector<std::shared_ptr<PhenotypeBase>>& members, bool selectAdded=false) {
+            population.reserve(population.size() + members.size());
+            if(selectAdded) selected.reserve(selected.size() + members.size());
+            for(const std::shared_ptr<PhenotypeBase>& member : members) {
+                population.push_back(member);
+                if(selectAdded) selected.push_back(population.size() - 1);
+            }
+        }
+
+        /// @brief Evaluate candidate members in one batch and append them. With
+        /// a surrogate screen set only the candidates it predicts most promising
+        /// are evaluated and appended, the rest are discarded unevaluated
+        /// @param candidates Unevaluated members, representations already set
+        /// @param selectAdded Add the appended members' indices to the selected vector
+        void evaluateAndAddMembers(const std::vector<std::shared_ptr<PhenotypeBase>>& candidates, bool selectAdded=false) {
+            std::vector<std::shared_ptr<PhenotypeBase>> chosen;
+            for(int c : screenAndEvaluate(candidates, true)) chosen.push_back(candidates[c]);
+            addPopulationMembers(chosen, selectAdded);
+        }
+
+        /// @brief Evaluate mutated copies of members in one batch and put each
+        /// in place of its member. With a surrogate screen set only the copies
+        /// it predicts most promising are evaluated and replace their member,
+        /// the other members are left unchanged. Mutants replace their member
+        /// whatever they score, so they are evaluated without the score bound
+        /// @param indices Index of the member each candidate replaces
+        /// @param candidates Unevaluated members, representations already set
+        void evaluateAndReplaceMembers(const std::vector<int>& indices, const std::vector<std::shared_ptr<PhenotypeBase>>& candidates) {
+            for(int c : screenAndEvaluate(candidates, false)) population[indices[c]] = candidates[c];
+        }
+
+        /// @brief Set a surrogate screen used by evaluateAndAddMembers(), the
+        /// current members are added to its training data
+        /// @param surrogate Screen to use, nullptr disables screening
+        void setSurrogate(std::shared_ptr<SurrogateScreen> surrogate) {
+            this->surrogate = surrogate;
+            if(!surrogate) return;
+            for(const auto& member : population) {
+                if(!ObjectiveBase::isRejected(member->getScore())) surrogate->observe(member->getRepresentation(), member->getScore());
+            }
+        }
+
+        /// @brief Get the surrogate screen, nullptr if none is set
+        const std::shared_ptr<SurrogateScreen>& getSurrogate() const {return surrogate;}
+
         void printScoresInline() {
             for(auto& m : population) {
                 m->printScore();
@@ -128,6 +190,32 @@ class Population {
         std::vector<std::shared_ptr<PhenotypeBase>> population;
         std::vector<int> selected;
         const std::unique_ptr<ObjectiveBase>& objective;
+        std::shared_ptr<SurrogateScreen> surrogate;
+
+        /// @brief Screen candidates with the surrogate if one is set, evaluate
+        /// the chosen ones in one batch and train the surrogate on them
+        /// @param bounded Evaluate under the objective's score bound
+        /// @return vector<int> of evaluated candidate indices, in input order
+        std::vector<int> screenAndEvaluate(const std::vector<std::shared_ptr<PhenotypeBase>>& candidates, bool bounded) {
+            std::vector<int> chosen;
+            if(surrogate) {
+                std::vector<const RepresentationBase*> representations;
+                for(const std::shared_ptr<PhenotypeBase>& candidate : candidates) representations.push_back(&candidate->getRepresentation());
+                chosen = surrogate->choose(representations);
+            } else {
+                chosen.resize(candidates.size());
+                std::iota(chosen.begin(), chosen.end(), 0);
+            }
+            std::vector<PhenotypeBase*> chosenPointers;
+            for(int c : chosen) chosenPointers.push_back(candidates[c].get());
+            std::vector<double> scores = objective->evaluateBatch(chosenPointers, bounded);
+            for(size_t i = 0; i < chosen.size(); i++) {
+                chosenPointers[i]->setScore(scores[i]);
+                //Rejected scores only say the member exceeded the score bound
+                if(surrogate && !ObjectiveBase::isRejected(scores[i])) surrogate->observe(chosenPointers[i]->getRepresentation(), scores[i]);
+            }
+            return chosen;
+        }
 
         /// @brief Sort population in ascending order by fitness value
         void sortAscending() {
@@ -0,0 +1,537 @@
+#ifndef PROCESSPOOLOBJECTIVE_HPP
+#define PROCESSPOOLOBJECTIVE_HPP
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <thread>
+#include <iostream>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include "Objective.hpp"
+#include "Representation.hpp"
+#include "phenotype.hpp"
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
+/// @brief ObjectiveBase adapter which evaluates genomes in a pool of worker
+/// processes, for objectives that crash, leak or keep global state.
+/// Each worker builds its own objective from objectiveFactory once started.
+/// Genomes are sent over a socket pair as their integer and double vector
+/// representations, rebuilt inside the worker from the empty phenotype /
+/// representation prototypes and evaluated there. The score comes back with
+/// any objective values the worker's phenotype holds, e.g. those written by a
+/// MultiObjectiveBase, which are set on the parent's phenotype before its
+/// score is ready, so a pool of MultiObjectiveBase workers can drive
+/// NSGA2GeneticAlgorithm. getCallCount() counts each
+/// genome once, however many times it had to be retried. POSIX only.
+///
+/// Workers are never forked from the GA process. The constructor forks one
+/// single threaded fork server, which forks every worker, including the ones
+/// restarting crashed or recycled workers, and passes its socket back. Construct
+/// the pool before starting any threads, so the fork server (and with it every
+/// worker running objectiveFactory) never inherits another thread's locks.
+///
+/// A dispatcher thread owns the workers: it keeps maxInFlightPerWorker genomes
+/// queued on every worker, restarts crashed workers and re-sends their
+/// in-flight genomes. evaluateAsync() returns as soon as the genome is queued,
+/// so e.g. PipelinedGeneticAlgorithm keeps breeding while the workers
+/// evaluate, evaluate() and evaluateBatch() queue their genomes and wait.
+class ProcessPoolObjective : public ObjectiveBase {
+    public:
+        /// @param objectiveFactory Called inside each worker process to build
+        /// the objective that worker evaluates with
+        /// @param emptyPhenotype Phenotype prototype used to rebuild genomes in workers
+        /// @param emptyRepresentation Representation prototype used to rebuild genomes in workers
+        /// @param numWorkers Number of worker processes, defaults to hardware concurrency
+        /// @param maxInFlightPerWorker Genomes queued per worker so it never waits on the parent
+        ProcessPoolObjective(std::function<std::unique_ptr<ObjectiveBase>()> objectiveFactory, std::shared_ptr<PhenotypeBase> emptyPhenotype, std::unique_ptr<RepresentationBase> emptyRepresentation, int numWorkers=-1, int maxInFlightPerWorker=2)
+        : objectiveFactory(objectiveFactory), emptyPhenotype(emptyPhenotype), emptyRepresentation(std::move(emptyRepresentation)), maxInFlightPerWorker(std::max(1, maxInFlightPerWorker)) {
+            if(numWorkers < 1) numWorkers = std::max(1u, std::thread::hardware_concurrency());
+            startForkServer();
+            workers.resize(numWorkers);
+            for(int w = 0; w < numWorkers; w++) spawnWorker(w);
+
+            if(socketpair(AF_UNIX, SOCK_STREAM, 0, wakeFds) < 0) {
+                std::cerr << "ProcessPoolObjective\nCould not create dispatcher wake up socket\nExiting Program\n";
+                exit(-1);
+            }
+            fcntl(wakeFds[0], F_SETFL, O_NONBLOCK);
+            fcntl(wakeFds[1], F_SETFL, O_NONBLOCK);
+            dispatcher = std::thread(&ProcessPoolObjective::dispatch, this);
+        }
+
+        virtual ~ProcessPoolObjective() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wakeDispatcher();
+            dispatcher.join();
+            for(Worker& worker : workers) {
+                if(worker.fd >= 0) close(worker.fd);
+            }
+            //The fork server gives idle workers a grace period to exit, then kills them
+            close(forkServerFd);
+            int status;
+            while(waitpid(forkServerPid, &status, 0) < 0 && errno == EINTR) {}
+            close(wakeFds[0]);
+            close(wakeFds[1]);
+        }
+
+        ProcessPoolObjective(const ProcessPoolObjective&) = delete;
+        ProcessPoolObjective& operator=(const ProcessPoolObjective&) = delete;
+
+        /// @brief Score given to a genome whose evaluation crashed every retry
+        void setFailureScore(double failureScore) {this->failureScore = failureScore;}
+
+        /// @brief Number of times a genome is re-sent after its worker crashed
+        void setMaxRetries(int maxRetries) {this->maxRetries = maxRetries;}
+
+        /// @brief Recycle a worker after it has evaluated n genomes, bounds
+        /// memory leaked by the wrapped objective, -1 never recycles
+        void setMaxEvaluationsPerWorker(int n) {this->maxEvaluationsPerWorker = n;}
+
+        /// @brief Number of workers restarted after crashing
+        int getCrashCount() const {return crashCount;}
+
+        /// @brief Number of workers restarted by setMaxEvaluationsPerWorker()
+        int getRecycleCount() const {return recycleCount;}
+
+        int getWorkerCount() const {return workers.size();}
+
+        /// @brief Genomes are queued to the dispatcher, so several threads may
+        /// evaluate at once
+        virtual bool isThreadSafe() const override {return true;}
+
+    protected:
+        virtual double fitnessFunction(PhenotypeBase& phenotype) override {
+            std::vector<std::future<double>> scores = submit(std::vector<PhenotypeBase*>{&phenotype}, false);
+            return scores[0].get();
+        }
+
+        virtual void fitnessFunctionBatch(const std::vector<PhenotypeBase*>& phenotypes, std::vector<double>& scores) override {
+            std::vector<std::future<double>> futures = submit(phenotypes, false);
+            for(size_t i = 0; i < futures.size(); i++) scores[i] = futures[i].get();
+        }
+
+        /// @brief Queue the genome and return without waiting for a worker
+        virtual std::future<double> fitnessFunctionAsync(PhenotypeBase& phenotype) override {
+            std::vector<std::future<double>> scores = submit(std::vector<PhenotypeBase*>{&phenotype}, true);
+            return std::move(scores[0]);
+        }
+
+    private:
+        /// @brief A genome waiting for, or being evaluated by, a worker
+        struct Task {
+            std::vector<char> message;
+            //Receives the objective values sent back with the score
+            PhenotypeBase* phenotype = nullptr;
+            std::promise<double> score;
+            int retries = 0;
+            //evaluateBatch() counts its own aborted calls, asynchronous ones are counted here
+            bool countAborted = false;
+        };
+
+        struct Worker {
+            pid_t pid = -1;
+            int fd = -1;
+            std::deque<std::shared_ptr<Task>> inFlight;
+            int evaluations = 0;
+        };
+
+        /// @brief Time idle workers get to exit at shutdown before being killed
+        static constexpr int shutdownGraceMilliseconds = 1000;
+
+        std::function<std::unique_ptr<ObjectiveBase>()> objectiveFactory;
+        std::shared_ptr<PhenotypeBase> emptyPhenotype;
+        std::unique_ptr<RepresentationBase> emptyRepresentation;
+        std::vector<Worker> workers;
+        int maxInFlightPerWorker;
+        std::atomic<int> maxRetries{2};
+        std::atomic<int> maxEvaluationsPerWorker{-1};
+        std::atomic<double> failureScore{std::numeric_limits<double>::max()};
+        std::atomic<int> crashCount{0};
+        std::atomic<int> recycleCount{0};
+
+        pid_t forkServerPid = -1;
+        int forkServerFd = -1;
+        int wakeFds[2] = {-1, -1};
+        std::thread dispatcher;
+        //Guards submitted and stopping, everything else belongs to the dispatcher
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Task>> submitted;
+        bool stopping = false;
+
+        bool needsRecycle(const Worker& worker) const {
+            return maxEvaluationsPerWorker > 0 && worker.evaluations + static_cast<int>(worker.inFlight.size()) >= maxEvaluationsPerWorker;
+        }
+
+        /// @brief Serialise the phenotypes on the calling thread and hand them
+        /// to the dispatcher
+        std::vector<std::future<double>> submit(const std::vector<PhenotypeBase*>& phenotypes, bool countAborted) {
+            std::vector<std::future<double>> scores;
+            std::vector<std::shared_ptr<Task>> tasks;
+            double scoreBound = getScoreBound();
+            for(PhenotypeBase* phenotype : phenotypes) {
+                std::shared_ptr<Task> task = std::make_shared<Task>();
+                task->message = serialise(phenotype->getRepresentation(), scoreBound);
+                task->phenotype = phenotype;
+                task->countAborted = countAborted;
+                scores.push_back(task->score.get_future());
+                tasks.push_back(task);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                submitted.insert(submitted.end(), tasks.begin(), tasks.end());
+            }
+            wakeDispatcher();
+            return scores;
+        }
+
+        void wakeDispatcher() {
+            char wake = 0;
+            //A full socket already has a wake up pending
+            send(wakeFds[1], &wake, 1, MSG_NOSIGNAL);
+        }
+
+        /// @brief Dispatcher thread main loop, runs until the destructor
+        void dispatch() {
+            std::deque<std::shared_ptr<Task>> pending;
+            std::vector<double> objectiveValues;
+            std::vector<pollfd> pollFds;
+            std::vector<int> pollWorkers;
+            while(true) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if(stopping) return;
+                    pending.insert(pending.end(), submitted.begin(), submitted.end());
+                    submitted.clear();
+                }
+
+                //Top up every worker's queue
+                for(int w = 0; w < static_cast<int>(workers.size()); w++) {
+                    Worker& worker = workers[w];
+                    while(!pending.empty() && static_cast<int>(worker.inFlight.size()) < maxInFlightPerWorker && !needsRecycle(worker)) {
+                        std::shared_ptr<Task> task = pending.front();
+                        pending.pop_front();
+                        worker.inFlight.push_back(task);
+                        if(!writeAll(worker.fd, task->message.data(), task->message.size())) {
+                            handleCrash(w, pending);
+                            //Top up the restarted worker too, otherwise nothing may
+                            //be in flight and the re-queued genomes would wait
+                            //for the next submit
+                            w--;
+                            break;
+                        }
+                    }
+                }
+
+                pollFds.clear();
+                pollWorkers.clear();
+                pollFds.push_back(pollfd{wakeFds[0], POLLIN, 0});
+                pollWorkers.push_back(-1);
+                for(int w = 0; w < static_cast<int>(workers.size()); w++) {
+                    if(workers[w].inFlight.empty()) continue;
+                    pollFds.push_back(pollfd{workers[w].fd, POLLIN, 0});
+                    pollWorkers.push_back(w);
+                }
+                if(poll(pollFds.data(), pollFds.size(), -1) < 0) {
+                    if(errno == EINTR) continue;
+                    std::cerr << "ProcessPoolObjective\npoll failed\nExiting Program\n";
+                    exit(-1);
+                }
+
+                for(size_t k = 0; k < pollFds.size(); k++) {
+                    if(!pollFds[k].revents) continue;
+                    int w = pollWorkers[k];
+                    if(w < 0) {
+                        char drain[64];
+                        while(recv(wakeFds[0], drain, sizeof(drain), 0) > 0) {}
+                        continue;
+                    }
+                    Worker& worker = workers[w];
+                    double score;
+                    int32_t numValues;
+                    if(!readAll(worker.fd, &score, sizeof(score)) || !readAll(worker.fd, &numValues, sizeof(numValues))) {
+                        handleCrash(w, pending);
+                        continue;
+                    }
+                    objectiveValues.resize(numValues);
+                    if(!readAll(worker.fd, objectiveValues.data(), objectiveValues.size() * sizeof(double))) {
+                        handleCrash(w, pending);
+                        continue;
+                    }
+                    std::shared_ptr<Task> task = worker.inFlight.front();
+                    worker.inFlight.pop_front();
+                    worker.evaluations++;
+                    if(numValues > 0) task->phenotype->setObjectiveValues(objectiveValues);
+                    finish(*task, score);
+                    if(needsRecycle(worker) && worker.inFlight.empty()) {
+                        //Closing the socket makes the idle worker exit, the fork server reaps it
+                        close(worker.fd);
+                        worker.fd = -1;
+                        spawnWorker(w);
+                        recycleCount++;
+                    }
+                }
+            }
+        }
+
+        void finish(Task& task, double score) {
+            if(task.countAborted && isRejected(score)) abortedCallCount++;
+            task.score.set_value(score);
+        }
+
+        /// @brief Kill and restart a dead worker and re-queue whatever it had
+        /// in flight, genomes past maxRetries are given failureScore
+        void handleCrash(int w, std::deque<std::shared_ptr<Task>>& pending) {
+            Worker& worker = workers[w];
+            std::deque<std::shared_ptr<Task>> lost = worker.inFlight;
+            //Still a zombie until the fork server's next spawn, so the pid cannot have been reused
+            kill(worker.pid, SIGKILL);
+            close(worker.fd);
+            worker.fd = -1;
+            crashCount++;
+            for(auto it = lost.rbegin(); it != lost.rend(); ++it) {
+                std::shared_ptr<Task> task = *it;
+                task->retries++;
+                if(task->retries > maxRetries) {
+                    std::cerr << "ProcessPoolObjective: genome failed " << task->retries << " times, assigning failure score\n";
+                    finish(*task, failureScore);
+                } else {
+                    pending.push_front(task);
+                }
+            }
+            spawnWorker(w);
+        }
+
+        /// @brief Message layout: int32 integer count, int32 double count,
+        /// double score bound, integer genes, double genes. The reply is the
+        /// double score, int32 objective value count, objective values
+        static std::vector<char> serialise(const RepresentationBase& representation, double scoreBound) {
+            std::vector<int> intScratch;
+            std::vector<double> doubleScratch;
+            GeneView<const int> ints = readIntegerGenes(representation, intScratch);
+            GeneView<const double> doubles = readDoubleGenes(representation, doubleScratch);
+            int32_t header[2] = {static_cast<int32_t>(ints.size()), static_cast<int32_t>(doubles.size())};
+            std::vector<char> message(sizeof(header) + sizeof(scoreBound) + ints.size() * sizeof(int) + doubles.size() * sizeof(double));
+            char* out = message.data();
+            std::copy(reinterpret_cast<const char*>(header), reinterpret_cast<const char*>(header) + sizeof(header), out);
+            out += sizeof(header);
+            std::copy(reinterpret_cast<const char*>(&scoreBound), reinterpret_cast<const char*>(&scoreBound) + sizeof(scoreBound), out);
+            out += sizeof(scoreBound);
+            std::copy(reinterpret_cast<const char*>(ints.data()), reinterpret_cast<const char*>(ints.data() + ints.size()), out);
+            out += ints.size() * sizeof(int);
+            std::copy(reinterpret_cast<const char*>(doubles.data()), reinterpret_cast<const char*>(doubles.data() + doubles.size()), out);
+            return message;
+        }
+
+        static bool writeAll(int fd, const void* data, size_t size) {
+            const char* p = static_cast<const char*>(data);
+            while(size > 0) {
+                ssize_t written = send(fd, p, size, MSG_NOSIGNAL);
+                if(written < 0 && errno == EINTR) continue;
+                if(written <= 0) return false;
+                p += written;
+                size -= written;
+            }
+            return true;
+        }
+
+        static bool readAll(int fd, void* data, size_t size) {
+            char* p = static_cast<char*>(data);
+            while(size > 0) {
+                ssize_t got = recv(fd, p, size, 0);
+                if(got < 0 && errno == EINTR) continue;
+                if(got <= 0) return false;
+                p += got;
+                size -= got;
+            }
+            return true;
+        }
+
+        /// @brief Send a worker's pid and socket over the fork server socket
+        static bool sendWorker(int fd, pid_t pid, int workerFd) {
+            char control[CMSG_SPACE(sizeof(int))];
+            std::memset(control, 0, sizeof(control));
+            iovec data{&pid, sizeof(pid)};
+            msghdr message{};
+            message.msg_iov = &data;
+            message.msg_iovlen = 1;
+            if(workerFd >= 0) {
+                message.msg_control = control;
+                message.msg_controllen = sizeof(control);
+                cmsghdr* header = CMSG_FIRSTHDR(&message);
+                header->cmsg_level = SOL_SOCKET;
+                header->cmsg_type = SCM_RIGHTS;
+                header->cmsg_len = CMSG_LEN(sizeof(int));
+                std::memcpy(CMSG_DATA(header), &workerFd, sizeof(int));
+            }
+            ssize_t sent;
+            while((sent = sendmsg(fd, &message, MSG_NOSIGNAL)) < 0 && errno == EINTR) {}
+            return sent == static_cast<ssize_t>(sizeof(pid));
+        }
+
+        /// @brief Receive a worker's pid and socket from the fork server
+        static bool receiveWorker(int fd, pid_t& pid, int& workerFd) {
+            char control[CMSG_SPACE(sizeof(int))];
+            iovec data{&pid, sizeof(pid)};
+            msghdr message{};
+            message.msg_iov = &data;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            ssize_t got;
+            while((got = recvmsg(fd, &message, 0)) < 0 && errno == EINTR) {}
+            if(got != static_cast<ssize_t>(sizeof(pid)) || pid <= 0) return false;
+            cmsghdr* header = CMSG_FIRSTHDR(&message);
+            if(!header || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) return false;
+            std::memcpy(&workerFd, CMSG_DATA(header), sizeof(int));
+            return true;
+        }
+
+        void startForkServer() {
+            int fds[2];
+            if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+                std::cerr << "ProcessPoolObjective\nCould not create socket pair for fork server\nExiting Program\n";
+                exit(-1);
+            }
+            //Stop buffered output being written twice
+            std::cout.flush();
+            std::cerr.flush();
+            pid_t pid = fork();
+            if(pid < 0) {
+                std::cerr << "ProcessPoolObjective\nCould not fork the fork server\nExiting Program\n";
+                exit(-1);
+            }
+            if(pid == 0) {
+                close(fds[0]);
+                runForkServer(fds[1]);
+                _exit(0);
+            }
+            close(fds[1]);
+            forkServerPid = pid;
+            forkServerFd = fds[0];
+        }
+
+        /// @brief Ask the fork server for a new worker in slot w
+        void spawnWorker(int w) {
+            char request = 0;
+            pid_t pid;
+            int fd;
+            if(!writeAll(forkServerFd, &request, 1) || !receiveWorker(forkServerFd, pid, fd)) {
+                std::cerr << "ProcessPoolObjective\nCould not fork worker process\nExiting Program\n";
+                exit(-1);
+            }
+            workers[w].pid = pid;
+            workers[w].fd = fd;
+            workers[w].evaluations = 0;
+            workers[w].inFlight.clear();
+        }
+
+        /// @brief Fork server main loop, forks a worker per request and exits
+        /// once the parent closes the socket, after stopping its workers
+        void runForkServer(int fd) {
+            //Every worker holds the write end, so the read end reports end of
+            //file once they have all exited
+            int aliveFds[2];
+            if(pipe(aliveFds) < 0) _exit(1);
+            fcntl(aliveFds[0], F_SETFD, FD_CLOEXEC);
+            fcntl(aliveFds[1], F_SETFD, FD_CLOEXEC);
+            std::vector<pid_t> children;
+            char request;
+            while(readAll(fd, &request, 1)) {
+                reapChildren(children);
+                int workerFds[2] = {-1, -1};
+                pid_t pid = -1;
+                if(socketpair(AF_UNIX, SOCK_STREAM, 0, workerFds) == 0) {
+                    pid = fork();
+                    if(pid == 0) {
+                        close(fd);
+                        close(workerFds[0]);
+                        close(aliveFds[0]);
+                        runWorker(workerFds[1]);
+                        _exit(0);
+                    }
+                    close(workerFds[1]);
+                    if(pid > 0) children.push_back(pid);
+                }
+                bool sent = sendWorker(fd, pid, pid > 0 ? workerFds[0] : -1);
+                if(workerFds[0] >= 0) close(workerFds[0]);
+                if(!sent) break;
+            }
+            close(fd);
+
+            //Workers exit once the parent has closed their sockets, give them a
+            //bounded time to do so before killing the rest
+            close(aliveFds[1]);
+            pollfd alive{aliveFds[0], POLLIN, 0};
+            while(poll(&alive, 1, shutdownGraceMilliseconds) < 0 && errno == EINTR) {}
+            reapChildren(children);
+            for(pid_t child : children) kill(child, SIGKILL);
+            for(pid_t child : children) {
+                int status;
+                while(waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+            }
+        }
+
+        /// @brief Reap exited workers without blocking
+        static void reapChildren(std::vector<pid_t>& children) {
+            for(auto it = children.begin(); it != children.end();) {
+                int status;
+                if(waitpid(*it, &status, WNOHANG) == *it) {
+                    it = children.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        /// @brief Worker process main loop, exits when the parent closes the socket
+        void runWorker(int fd) {
+            std::unique_ptr<ObjectiveBase> objective = objectiveFactory();
+            std::vector<int> ints;
+            std::vector<double> doubles;
+            while(true) {
+                int32_t header[2];
+                double scoreBound;
+                if(!readAll(fd, header, sizeof(header))) return;
+                if(!readAll(fd, &scoreBound, sizeof(scoreBound))) return;
+                objective->setScoreBound(scoreBound);
+                ints.resize(header[0]);
+                doubles.resize(header[1]);
+                if(!readAll(fd, ints.data(), ints.size() * sizeof(int))) return;
+                if(!readAll(fd, doubles.data(), doubles.size() * sizeof(double))) return;
+
+                std::unique_ptr<RepresentationBase> representation = emptyRepresentation->emptyCopy();
+                if(!ints.empty()) representation->setIntegerVectorRepresentation(ints);
+                if(!doubles.empty()) representation->setDoubleVectorRepresentation(doubles);
+                std::shared_ptr<PhenotypeBase> phenotype = emptyPhenotype->emptyCopy();
+                phenotype->setRepresentation_NOEVALUATE(std::move(representation));
+                //The bound sent is infinity unless the parent's call was bounded
+                double score = objective->evaluate(*phenotype, true);
+                const std::vector<double>& objectiveValues = phenotype->getObjectiveValues();
+                int32_t numValues = objectiveValues.size();
+                if(!writeAll(fd, &score, sizeof(score))) return;
+                if(!writeAll(fd, &numValues, sizeof(numValues))) return;
+                if(!writeAll(fd, objectiveValues.data(), objectiveValues.size() * sizeof(double))) return;
+            }
+        }
+};
+#endif
@@ -0,0 +1,51 @@
+#ifndef RANDOMSTREAM_HPP
+#define RANDOMSTREAM_HPP
+#include <random>
+#include <cstdint>
+
+/// @brief Random engines drawn from by the built-in selection, variation and
+/// reproduction functions. Every thread has its own engines, seeded from
+/// std::random_device, so operators can run on several threads at once.
+/// HyperparameterSweep swaps each run's saved engines in before running it,
+/// giving every run its own reproducible stream whichever thread it lands on
+namespace RandomStream {
+    /// @brief 32 bit engine of the calling thread
+    std::mt19937& engine() {
+        thread_local std::mt19937 mt(std::random_device{}());
+        return mt;
+    }
+
+    /// @brief 64 bit engine of the calling thread, used for word sized draws
+    std::mt19937_64& engine64() {
+        thread_local std::mt19937_64 mt(std::random_device{}());
+        return mt;
+    }
+
+    /// @brief Seed and call counter of the calling thread's parallel breeding
+    /// functions, e.g. Variation::parallelOrderedCrossover(), which derive one
+    /// engine per pair from them
+    struct BreedingState {
+        uint64_t seed = engine64()();
+        uint64_t calls = 0;
+    };
+
+    BreedingState& breedingState() {
+        thread_local BreedingState state;
+        return state;
+    }
+
+    /// @brief Reseed both engines and the breeding state of the calling
+    /// thread, so one call makes a run reproducible
+    void seed(uint64_t seed) {
+        std::seed_seq seedSequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+        engine().seed(seedSequence);
+        engine64().seed(seedSequence);
+        //A sequence of its own, so the breeding seed is not engine64's first draw
+        std::seed_seq breedingSequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), 1u};
+        uint32_t breedingWords[2];
+        breedingSequence.generate(breedingWords, breedingWords + 2);
+        breedingState().seed = static_cast<uint64_t>(breedingWords[0]) | static_cast<uint64_t>(breedingWords[1]) << 32;
+        breedingState().calls = 0;
+    }
+}
+#endif
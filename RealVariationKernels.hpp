@@ -0,0 +1,105 @@
+#ifndef REALVARIATIONKERNELS_HPP
+#define REALVARIATIONKERNELS_HPP
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+namespace Variation {
+    /// @brief Batch kernels for real-coded operators. Every kernel works on a
+    /// contiguous row-major individuals x dimensions matrix, random numbers are
+    /// drawn up front into their own matrix so the arithmetic loops are
+    /// branch free and can be auto-vectorised by the compiler.
+    namespace Kernels {
+        enum class BoundHandling {Clamp, Reflect};
+
+        /// @brief Fill n uniform [0, 1) draws
+        void fillUniform(double* out, size_t n, std::mt19937& mt) {
+            std::uniform_real_distribution<double> realDist(0.0, 1.0);
+            for(size_t i = 0; i < n; i++) out[i] = realDist(mt);
+        }
+
+        /// @brief Fill n standard normal draws
+        void fillNormal(double* out, size_t n, std::mt19937& mt) {
+            std::normal_distribution<double> normalDist(0.0, 1.0);
+            for(size_t i = 0; i < n; i++) out[i] = normalDist(mt);
+        }
+
+        /// @brief Simulated binary crossover over n genes, a gene is crossed
+        /// when its mask draw is below geneCrossoverRate and otherwise copied
+        /// from the parent unchanged (beta = 1)
+        /// @param u n uniform draws in [0, 1)
+        /// @param mask n uniform draws deciding which genes are crossed
+        /// @param distributionIndex Larger values keep children closer to parents
+        void simulatedBinaryCrossover(const double* parent1, const double* parent2, const double* u, const double* mask, double* child1, double* child2, size_t n, double distributionIndex, double geneCrossoverRate) {
+            const double exponent = 1.0 / (distributionIndex + 1.0);
+            for(size_t i = 0; i < n; i++) {
+                double base = u[i] <= 0.5 ? 2.0 * u[i] : 1.0 / (2.0 * (1.0 - u[i]));
+                double beta = mask[i] < geneCrossoverRate ? std::pow(base, exponent) : 1.0;
+                double sum = parent1[i] + parent2[i];
+                double difference = parent2[i] - parent1[i];
+                child1[i] = 0.5 * (sum - beta * difference);
+                child2[i] = 0.5 * (sum + beta * difference);
+            }
+        }
+
+        /// @brief Polynomial mutation of a rows x dimensions matrix, a gene is
+        /// perturbed when its mask draw is below geneMutationRate
+        /// @param u rows x dimensions uniform draws shaping the perturbation
+        /// @param mask rows x dimensions uniform draws deciding which genes mutate
+        /// @param range Per dimension (upper - lower) bound width
+        void polynomialMutation(double* genes, const double* u, const double* mask, const double* range, int rows, int dimensions, double geneMutationRate, double distributionIndex) {
+            const double exponent = 1.0 / (distributionIndex + 1.0);
+            for(int r = 0; r < rows; r++) {
+                double* row = genes + static_cast<size_t>(r) * dimensions;
+                const double* uRow = u + static_cast<size_t>(r) * dimensions;
+                const double* maskRow = mask + static_cast<size_t>(r) * dimensions;
+                for(int d = 0; d < dimensions; d++) {
+                    bool lower = uRow[d] < 0.5;
+                    double base = lower ? 2.0 * uRow[d] : 2.0 * (1.0 - uRow[d]);
+                    double p = std::pow(base, exponent);
+                    double delta = lower ? p - 1.0 : 1.0 - p;
+                    double apply = maskRow[d] < geneMutationRate ? 1.0 : 0.0;
+                    row[d] += apply * delta * range[d];
+                }
+            }
+        }
+
+        /// @brief Gaussian mutation of a rows x dimensions matrix, step size is
+        /// sigma scaled by the bound width of each dimension
+        /// @param z rows x dimensions standard normal draws
+        /// @param mask rows x dimensions uniform draws deciding which genes mutate
+        void gaussianMutation(double* genes, const double* z, const double* mask, const double* range, int rows, int dimensions, double geneMutationRate, double sigma) {
+            for(int r = 0; r < rows; r++) {
+                double* row = genes + static_cast<size_t>(r) * dimensions;
+                const double* zRow = z + static_cast<size_t>(r) * dimensions;
+                const double* maskRow = mask + static_cast<size_t>(r) * dimensions;
+                for(int d = 0; d < dimensions; d++) {
+                    double apply = maskRow[d] < geneMutationRate ? 1.0 : 0.0;
+                    row[d] += apply * sigma * range[d] * zRow[d];
+                }
+            }
+        }
+
+        /// @brief Bring every gene of a rows x dimensions matrix back inside
+        /// [lower, upper], reflection mirrors off the violated bound and is then
+        /// clamped in case the step was wider than the bounds
+        void applyBounds(double* genes, const double* lower, const double* upper, int rows, int dimensions, BoundHandling boundHandling) {
+            for(int r = 0; r < rows; r++) {
+                double* row = genes + static_cast<size_t>(r) * dimensions;
+                if(boundHandling == BoundHandling::Reflect) {
+                    for(int d = 0; d < dimensions; d++) {
+                        double x = row[d];
+                        x = x < lower[d] ? 2.0 * lower[d] - x : x;
+                        x = x > upper[d] ? 2.0 * upper[d] - x : x;
+                        row[d] = x;
+                    }
+                }
+                for(int d = 0; d < dimensions; d++) {
+                    row[d] = std::min(std::max(row[d], lower[d]), upper[d]);
+                }
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,54 @@
+#ifndef REALVECTORREPRESENTATION_HPP
+#define REALVECTORREPRESENTATION_HPP
+#include <vector>
+#include <string>
+#include <sstream>
+#include <memory>
+#include "Representation.hpp"
+
+/// @brief Real-valued chromosome for continuous problems, genes are exposed
+/// through get/setDoubleVectorRepresentation() so the real-coded operators in
+/// Variation can gather them into contiguous batches
+class RealVectorRepresentation : public RepresentationBase {
+    public:
+        RealVectorRepresentation() {}
+
+        RealVectorRepresentation(const std::vector<double>& genes) : genes(genes) {}
+
+        virtual std::string toString() const override {
+            std::stringstream ss;
+            for(double gene : genes) {
+                ss << gene << ",";
+            }
+            return ss.str();
+        }
+
+        virtual int size() const override {return genes.size();}
+
+        virtual std::unique_ptr<RepresentationBase> emptyCopy() const override {
+            return std::make_unique<RealVectorRepresentation>();
+        }
+
+        virtual std::unique_ptr<RepresentationBase> deepCopy() const override {
+            return std::make_unique<RealVectorRepresentation>(genes);
+        }
+
+        virtual std::vector<double> getDoubleVectorRepresentation() const override {return genes;}
+
+        using RepresentationBase::setDoubleVectorRepresentation;
+        virtual void setDoubleVectorRepresentation(std::vector<double>& rep) override {genes = rep;}
+
+        virtual GeneView<const double> getDoubleGenes() const override {return GeneView<const double>(genes.data(), genes.size());}
+
+        virtual GeneView<double> getMutableDoubleGenes() override {return GeneView<double>(genes);}
+
+        virtual bool hasMutableDoubleGenes() const override {return true;}
+
+        /// @brief Read only access to genes without copying
+        /// @return const reference to gene vector
+        const std::vector<double>& getGenes() const {return genes;}
+
+    private:
+        std::vector<double> genes;
+};
+#endif
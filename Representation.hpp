@@ -3,6 +3,37 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <functional>
+#include <cstddef>
+#include <type_traits>
+
+/// @brief Non-owning view of contiguous genes, a pointer and a size. Stands in
+/// for std::span<T> (C++20) so operators can read and write genes in place
+template <typename T>
+class GeneView {
+    public:
+        GeneView() {}
+
+        GeneView(T* data, std::size_t size) : pointer(data), count(size) {}
+
+        GeneView(std::vector<typename std::remove_const<T>::type>& genes) : pointer(genes.data()), count(genes.size()) {}
+
+        /// @brief Allows GeneView<int> to convert to GeneView<const int>
+        template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+        GeneView(const GeneView<U>& other) : pointer(other.data()), count(other.size()) {}
+
+        T* data() const {return pointer;}
+        std::size_t size() const {return count;}
+        bool empty() const {return count == 0;}
+        T& operator[](std::size_t i) const {return pointer[i];}
+        T* begin() const {return pointer;}
+        T* end() const {return pointer + count;}
+
+    private:
+        T* pointer = nullptr;
+        std::size_t count = 0;
+};
+
 class RepresentationBase {
     public:
         virtual ~RepresentationBase() = default;
@@ -17,9 +48,129 @@ class RepresentationBase {
         virtual std::vector<double> getDoubleVectorRepresentation() const {return std::vector<double>{};}
         virtual void setIntegerVectorRepresentation(std::vector<int>& rep) {return;}
         virtual void setDoubleVectorRepresentation() {return;}
+        virtual void setDoubleVectorRepresentation(std::vector<double>&) {return;}
+        //VIEW - optional, override when genes are stored contiguously so the
+        //built-in operators read and write them in place instead of copying.
+        //An empty view means no view is available and the get / set copies
+        //above are used. A view is invalidated by any change to the
+        //representation. Only expose mutable views if writing through them
+        //leaves the representation consistent
+        virtual GeneView<const int> getIntegerGenes() const {return {};}
+        virtual GeneView<int> getMutableIntegerGenes() {return {};}
+        virtual GeneView<const double> getDoubleGenes() const {return {};}
+        virtual GeneView<double> getMutableDoubleGenes() {return {};}
+        //True when the getMutable*Genes() above return views, lets GeneWriter
+        //decide from a const parent whether a child can be written in place
+        virtual bool hasMutableIntegerGenes() const {return false;}
+        virtual bool hasMutableDoubleGenes() const {return false;}
 };
 std::ostream& operator<<(std::ostream& os, const RepresentationBase& rep) {
     os << rep.toString();
     return os;
 }
+
+/// @brief Read a representation's integer genes, a view of its own storage
+/// when it has one, otherwise a copy held in scratch
+/// @param scratch Buffer for the copy, must outlive the returned view
+GeneView<const int> readIntegerGenes(const RepresentationBase& rep, std::vector<int>& scratch) {
+    GeneView<const int> genes = rep.getIntegerGenes();
+    if(!genes.empty()) return genes;
+    scratch = rep.getIntegerVectorRepresentation();
+    return GeneView<const int>(scratch.data(), scratch.size());
+}
+
+/// @brief Read a representation's double genes, a view of its own storage
+/// when it has one, otherwise a copy held in scratch
+/// @param scratch Buffer for the copy, must outlive the returned view
+GeneView<const double> readDoubleGenes(const RepresentationBase& rep, std::vector<double>& scratch) {
+    GeneView<const double> genes = rep.getDoubleGenes();
+    if(!genes.empty()) return genes;
+    scratch = rep.getDoubleVectorRepresentation();
+    return GeneView<const double>(scratch.data(), scratch.size());
+}
+
+/// @brief Builds the genes of a new representation of the same type as a
+/// parent. When the parent has mutable views of the right size the child
+/// starts as a deep copy of it and genes() views the child's own storage, so
+/// nothing is copied afterwards. Otherwise the child is an emptyCopy() of the
+/// parent and genes() views a scratch buffer that release() stores with
+/// set*VectorRepresentation(). T is int or double
+template <typename T>
+class GeneWriter {
+    static_assert(std::is_same<T, int>::value || std::is_same<T, double>::value, "GeneWriter<T> supports int and double genes");
+
+    public:
+        /// @param parent Representation whose type the child takes
+        /// @param size Number of genes the child will hold
+        GeneWriter(const RepresentationBase& parent, int size) {
+            if(hasMutableGenes(parent) && static_cast<int>(parentGenes(parent).size()) == size) {
+                child = parent.deepCopy();
+                view = mutableGenes(*child);
+            }
+            if(!child || static_cast<int>(view.size()) != size) {
+                child = parent.emptyCopy();
+                scratch.assign(size, T());
+                view = GeneView<T>(scratch);
+                usesScratch = true;
+            }
+        }
+
+        /// @brief Writable genes of the child, the starting values are
+        /// unspecified
+        GeneView<T> genes() const {return view;}
+
+        /// @brief Finish writing and take the child representation
+        std::unique_ptr<RepresentationBase> release() {
+            if(usesScratch) {
+                if constexpr (std::is_same<T, int>::value) {
+                    child->setIntegerVectorRepresentation(scratch);
+                } else {
+                    child->setDoubleVectorRepresentation(scratch);
+                }
+            }
+            return std::move(child);
+        }
+
+    private:
+        std::unique_ptr<RepresentationBase> child;
+        std::vector<T> scratch;
+        GeneView<T> view;
+        bool usesScratch = false;
+
+        static GeneView<const T> parentGenes(const RepresentationBase& rep) {
+            if constexpr (std::is_same<T, int>::value) {
+                return rep.getIntegerGenes();
+            } else {
+                return rep.getDoubleGenes();
+            }
+        }
+
+        static bool hasMutableGenes(const RepresentationBase& rep) {
+            if constexpr (std::is_same<T, int>::value) {
+                return rep.hasMutableIntegerGenes();
+            } else {
+                return rep.hasMutableDoubleGenes();
+            }
+        }
+
+        static GeneView<T> mutableGenes(RepresentationBase& rep) {
+            if constexpr (std::is_same<T, int>::value) {
+                return rep.getMutableIntegerGenes();
+            } else {
+                return rep.getMutableDoubleGenes();
+            }
+        }
+};
+
+/// @brief Hash of a representation's integer and double genes, equal genomes
+/// hash equally. Used to spot duplicate genomes without comparing them
+std::size_t hashGenes(const RepresentationBase& rep) {
+    std::size_t hash = 0;
+    auto combine = [&](std::size_t value) {hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);};
+    std::vector<int> integerScratch;
+    std::vector<double> doubleScratch;
+    for(int gene : readIntegerGenes(rep, integerScratch)) combine(std::hash<int>()(gene));
+    for(double gene : readDoubleGenes(rep, doubleScratch)) combine(std::hash<double>()(gene));
+    return hash;
+}
 #endif
\ No newline at end of file
@@ -4,13 +4,23 @@
 #include "TerminationCondition.hpp"
 
 namespace Reproduction {
-    /// @brief 
+    /// @brief Keep the n best members. When n members survive, the score of
+    /// the worst becomes the objective's score bound for new children, as a
+    /// child scoring worse can never survive the next call while the survivors
+    /// keep their scores, otherwise the bound is cleared. Full evaluations of
+    /// members re-scored in place raise the bound, see ObjectiveBase::raiseScoreBound()
     /// @param population Population object
     /// @param n number of population that survive
     void nElitism(Population& population, int n, TerminationManager& terminationManager) {
         if(terminationManager.checkTermination()) return;
         population.sort();
         population.resizePopulation(std::min(population.size(), n));
+        const std::unique_ptr<ObjectiveBase>& objective = population.getObjective();
+        if(population.size() == n && n > 0) {
+            objective->setScoreBound(population[n - 1].getScore());
+        } else {
+            objective->clearScoreBound();
+        }
     }
 }
 #endif
\ No newline at end of file
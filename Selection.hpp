@@ -5,6 +5,7 @@
 #include "TerminationCondition.hpp"
 #include "phenotype.hpp"
 #include "Population.hpp"
+#include "RandomStream.hpp"
 
 namespace Selection {
     void linearRankingSelection(Population& population, int numToSelect, TerminationManager& terminationManager, bool verbose=false) {
@@ -39,7 +40,7 @@ namespace Selection {
         if(verbose) std::cout << "Sum of probabilities = " << sum << "\n";
 
         population.reserveSelected(numToSelect);
-        std::default_random_engine generator;
+        std::mt19937& generator = RandomStream::engine();
         std::discrete_distribution<int> dist(probabilities.begin(), probabilities.end());
         for(int i = 0; i < numToSelect; i++) {
             int selected = dist(generator);
@@ -61,5 +62,28 @@ namespace Selection {
             population.select(i);
         }
     }
+
+    /// @brief Binary tournament selection, each pick is the better scoring of
+    /// two uniformly drawn members. Used with NSGA2GeneticAlgorithm where the
+    /// score encodes front rank and crowding distance
+    /// @param population Population object
+    /// @param numToSelect Number of members to select, with replacement
+    /// @param terminationManager Termination manager
+    void binaryTournamentSelection(Population& population, int numToSelect, TerminationManager& terminationManager) {
+        if(terminationManager.checkTermination()) return;
+        population.clearSelected();
+        if(population.size() < 2) {
+            std::cerr << "binaryTournamentSelection:\ncannot run a tournament on fewer than two individuals\n";
+            exit(-1);
+        }
+        std::mt19937& mt = RandomStream::engine();
+        std::uniform_int_distribution<int> memberDist(0, population.size() - 1);
+        population.reserveSelected(numToSelect);
+        for(int i = 0; i < numToSelect; i++) {
+            int a = memberDist(mt);
+            int b = memberDist(mt);
+            population.select(population[b] < population[a] ? b : a);
+        }
+    }
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,228 @@
+#ifndef STAGNATIONMONITOR_HPP
+#define STAGNATIONMONITOR_HPP
+#include <vector>
+#include <deque>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <unordered_set>
+#include "Population.hpp"
+#include "TerminationCondition.hpp"
+#include "phenotype.hpp"
+#include "RandomStream.hpp"
+
+/// @brief Watches the best score and genome diversity of a population over a
+/// sliding window of generations and reseeds it when the search has stalled.
+/// Stagnation is declared when the best score has improved by less than
+/// minRelativeImprovement * |best| over the last window generations, or when
+/// the fraction of distinct genomes drops below minDiversity. Restart replaces
+/// every member except the eliteCount best, PartialReseed replaces
+/// reseedFraction of the non-elite members, duplicates first and then the
+/// worst. Improvement is only judged once window generations have passed since
+/// the start or the last event, so a restart has time to take effect, while a
+/// collapse in diversity is acted on as soon as it is seen. Set on a
+/// GeneticAlgorithm with GeneticAlgorithm::setStagnationMonitor(), events are
+/// reported in its progress reports and final summary
+class StagnationMonitor {
+    public:
+        enum class RecoveryAction {Restart, PartialReseed};
+
+        /// @brief Generates a new genome, given a random elite as a template
+        using GenomeGenerator = std::function<std::unique_ptr<RepresentationBase>(const RepresentationBase& elite, std::mt19937& mt)>;
+
+        /// @brief One detected stagnation and the recovery applied
+        struct StagnationEvent {
+            int generation;
+            int evaluations;
+            double bestScore;
+            double diversity;
+            bool improvementStalled;
+            bool diversityCollapsed;
+            RecoveryAction action;
+            int replacedCount;
+        };
+
+        /// @param window Generations over which improvement is measured
+        /// @param minRelativeImprovement Relative best score improvement below
+        /// which the search counts as stalled
+        /// @param minDiversity Fraction of distinct genomes below which the
+        /// population counts as collapsed, 0 disables the check
+        /// @param action Recovery applied on stagnation
+        /// @param eliteCount Best members never replaced
+        /// @param reseedFraction Fraction of non-elite members replaced by
+        /// PartialReseed
+        /// @param generator New genome generator, defaults to a random shuffle
+        /// of an elite's integer genes after the first (permutation genomes)
+        /// @param verbose Print each event as it happens
+        StagnationMonitor(int window=50, double minRelativeImprovement=1e-4, double minDiversity=0.1, RecoveryAction action=RecoveryAction::PartialReseed, int eliteCount=1, double reseedFraction=0.5, GenomeGenerator generator=nullptr, bool verbose=false)
+        : window(window), minRelativeImprovement(minRelativeImprovement), minDiversity(minDiversity), action(action), eliteCount(eliteCount), reseedFraction(reseedFraction), generator(generator), verbose(verbose) {
+            if(window < 1) {
+                std::cerr << "StagnationMonitor::StagnationMonitor\nwindow must be at least 1, got " << window << "\nExiting Program\n";
+                exit(-1);
+            }
+            if(!this->generator) this->generator = shuffledGenome;
+            mt.seed(RandomStream::engine()());
+        }
+
+        /// @brief Record one generation and recover if the population has
+        /// stagnated, judging improvement by the best member's score
+        /// @param population Population sorted best -> worst
+        /// @return true if members were replaced, the population is then unsorted
+        bool update(Population& population, TerminationManager& terminationManager) {
+            if(population.size() == 0) {
+                generation++;
+                return false;
+            }
+            return update(population, terminationManager, population[0].getScore());
+        }
+
+        /// @brief Record one generation and recover if the population has
+        /// stagnated
+        /// @param population Population sorted best -> worst
+        /// @param best Score improvement is judged by, lower is better, e.g.
+        /// GeneticAlgorithm::progressScore()
+        /// @return true if members were replaced, the population is then unsorted
+        bool update(Population& population, TerminationManager& terminationManager, double best) {
+            generation++;
+            if(population.size() == 0) return false;
+            double diversity = distinctFraction(population);
+            bestHistory.push_back(best);
+            if(static_cast<int>(bestHistory.size()) > window + 1) bestHistory.pop_front();
+
+            //Improvement is not judged until a full window has passed since the
+            //start or the last event, collapse is checked every generation
+            bool stalled = false;
+            if(static_cast<int>(bestHistory.size()) > window) {
+                double improvement = bestHistory.front() - bestHistory.back();
+                stalled = improvement <= minRelativeImprovement * std::abs(bestHistory.front());
+            }
+            bool collapsed = diversity < minDiversity;
+            if(!stalled && !collapsed) return false;
+            if(terminationManager.checkTermination()) return false;
+
+            int replaced = recover(population);
+            StagnationEvent event{generation, population.getObjective()->getCallCount(), best, diversity, stalled, collapsed, action, replaced};
+            events.push_back(event);
+            if(verbose) printEvent(event);
+            bestHistory.clear();
+            return replaced > 0;
+        }
+
+        /// @brief Every stagnation detected, in order
+        const std::vector<StagnationEvent>& getEvents() const {return events;}
+
+        /// @brief Number of full restarts made
+        int getRestartCount() const {return countEvents(RecoveryAction::Restart);}
+
+        /// @brief Number of partial reseeds made
+        int getReseedCount() const {return countEvents(RecoveryAction::PartialReseed);}
+
+        /// @brief Total members replaced over every event
+        int getReplacedCount() const {
+            int replaced = 0;
+            for(const StagnationEvent& event : events) replaced += event.replacedCount;
+            return replaced;
+        }
+
+        void printSummary() const {
+            std::cout << "Stagnation events: " << events.size()
+                      << " (restarts " << getRestartCount()
+                      << ", reseeds " << getReseedCount()
+                      << ", members replaced " << getReplacedCount() << ")\n";
+        }
+
+        void printEvent(const StagnationEvent& event) const {
+            std::cout << "StagnationMonitor: generation " << event.generation
+                      << ", evaluations " << event.evaluations
+                      << ", best " << event.bestScore
+                      << ", distinct fraction " << event.diversity
+                      << (event.improvementStalled ? ", stalled" : "")
+                      << (event.diversityCollapsed ? ", collapsed" : "")
+                      << " -> " << (event.action == RecoveryAction::Restart ? "restart" : "reseed")
+                      << " " << event.replacedCount << " members\n";
+        }
+
+    private:
+        int window;
+        double minRelativeImprovement;
+        double minDiversity;
+        RecoveryAction action;
+        int eliteCount;
+        double reseedFraction;
+        GenomeGenerator generator;
+        bool verbose;
+        std::mt19937 mt;
+        int generation = 0;
+        std::deque<double> bestHistory;
+        std::vector<StagnationEvent> events;
+
+        static std::unique_ptr<RepresentationBase> shuffledGenome(const RepresentationBase& elite, std::mt19937& mt) {
+            std::vector<int> genes = elite.getIntegerVectorRepresentation();
+            if(genes.empty()) {
+                std::cerr << "StagnationMonitor\nDefault generator needs integer genes, pass a GenomeGenerator for this representation\nExiting Program\n";
+                exit(-1);
+            }
+            //Keep the first gene, tours start from a fixed city
+            std::shuffle(genes.begin() + 1, genes.end(), mt);
+            std::unique_ptr<RepresentationBase> genome = elite.deepCopy();
+            genome->setIntegerVectorRepresentation(genes);
+            return genome;
+        }
+
+        static double distinctFraction(const Population& population) {
+            std::unordered_set<std::size_t> distinct;
+            for(int i = 0; i < population.size(); i++) distinct.insert(hashGenes(population[i].getRepresentation()));
+            return static_cast<double>(distinct.size()) / population.size();
+        }
+
+        int countEvents(RecoveryAction recoveryAction) const {
+            return std::count_if(events.begin(), events.end(), [&](const StagnationEvent& event) {return event.action == recoveryAction;});
+        }
+
+        /// @brief Replace members with generated genomes, evaluated as one batch
+        /// @return Number of members replaced
+        int recover(Population& population) {
+            int n = population.size();
+            int elites = std::min(std::max(eliteCount, 0), n);
+            std::vector<int> replace;
+            if(action == RecoveryAction::Restart) {
+                for(int i = elites; i < n; i++) replace.push_back(i);
+            } else {
+                //Duplicates of earlier (better) members first, then the worst
+                std::unordered_set<std::size_t> seen;
+                std::vector<int> duplicates;
+                std::vector<int> unique;
+                for(int i = 0; i < n; i++) {
+                    bool duplicate = !seen.insert(hashGenes(population[i].getRepresentation())).second;
+                    if(i < elites) continue;
+                    (duplicate ? duplicates : unique).push_back(i);
+                }
+                int count = std::lround(reseedFraction * (n - elites));
+                std::reverse(unique.begin(), unique.end());
+                replace = duplicates;
+                replace.insert(replace.end(), unique.begin(), unique.end());
+                replace.resize(std::min<int>(replace.size(), count));
+            }
+            if(replace.empty()) return 0;
+
+            std::uniform_int_distribution<int> eliteDist(0, std::max(elites, 1) - 1);
+            std::vector<PhenotypeBase*> replaced;
+            for(int i : replace) {
+                PhenotypeBase& member = population.getPopulationMember(i);
+                member.setRepresentation_NOEVALUATE(generator(population[eliteDist(mt)].getRepresentation(), mt));
+                replaced.push_back(&member);
+            }
+            //Replacements take members' places whatever they score, so they
+            //are evaluated in full
+            std::vector<double> scores = population.getObjective()->evaluateBatch(replaced);
+            for(size_t i = 0; i < replaced.size(); i++) {
+                replaced[i]->setScore(scores[i]);
+                if(population.getSurrogate()) population.getSurrogate()->observe(replaced[i]->getRepresentation(), scores[i]);
+            }
+            return replaced.size();
+        }
+};
+#endif
@@ -0,0 +1,308 @@
+#ifndef SURROGATE_HPP
+#define SURROGATE_HPP
+#include <vector>
+#include <memory>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <limits>
+#include "Representation.hpp"
+
+/// @brief Cheap model of the objective trained on genomes that have already
+/// been evaluated
+class SurrogateModelBase {
+    public:
+        virtual ~SurrogateModelBase() = default;
+        /// @brief Add an evaluated genome to the training data
+        virtual void addSample(const RepresentationBase& representation, double score) = 0;
+        /// @brief Predict the score of an unevaluated genome
+        virtual double predict(const RepresentationBase& representation) = 0;
+        virtual int sampleCount() const = 0;
+};
+
+/// @brief k nearest neighbour surrogate over a bounded archive of evaluated
+/// genomes, predictions are the inverse distance weighted mean score of the k
+/// closest. TourEdge counts the edges of one tour missing from the other
+/// (rotation / direction independent), Hamming compares integer genes position
+/// by position and Euclidean uses the double genes
+class KNearestNeighbourSurrogate : public SurrogateModelBase {
+    public:
+        enum class GenomeDistance {TourEdge, Hamming, Euclidean};
+
+        /// @param distance Genome distance used to find neighbours
+        /// @param k Number of neighbours averaged
+        /// @param capacity Archive size, oldest samples are overwritten
+        KNearestNeighbourSurrogate(GenomeDistance distance=GenomeDistance::TourEdge, int k=5, int capacity=256)
+        : distance(distance), k(k), capacity(capacity) {}
+
+        virtual void addSample(const RepresentationBase& representation, double score) override {
+            Sample sample;
+            sample.score = score;
+            if(distance == GenomeDistance::Euclidean) {
+                sample.doubleGenes = representation.getDoubleVectorRepresentation();
+            } else {
+                sample.integerGenes = representation.getIntegerVectorRepresentation();
+                if(distance == GenomeDistance::TourEdge) sample.successor = successors(sample.integerGenes);
+            }
+            if(static_cast<int>(archive.size()) < capacity) {
+                archive.push_back(std::move(sample));
+            } else {
+                archive[next] = std::move(sample);
+                next = (next + 1) % capacity;
+            }
+        }
+
+        virtual double predict(const RepresentationBase& representation) override {
+            if(archive.empty()) return 0.0;
+            GeneView<const int> integerGenes;
+            GeneView<const double> doubleGenes;
+            if(distance == GenomeDistance::Euclidean) {
+                doubleGenes = readDoubleGenes(representation, doubleScratch);
+            } else {
+                integerGenes = readIntegerGenes(representation, integerScratch);
+            }
+            distances.resize(archive.size());
+            for(size_t a = 0; a < archive.size(); a++) {
+                distances[a] = std::make_pair(sampleDistance(archive[a], integerGenes, doubleGenes), static_cast<int>(a));
+            }
+            int neighbours = std::min<int>(k, distances.size());
+            std::partial_sort(distances.begin(), distances.begin() + neighbours, distances.end());
+            double weightedSum = 0.0;
+            double weightSum = 0.0;
+            for(int i = 0; i < neighbours; i++) {
+                //Exact match, return its score
+                if(distances[i].first <= 0.0) return archive[distances[i].second].score;
+                double weight = 1.0 / distances[i].first;
+                weightedSum += weight * archive[distances[i].second].score;
+                weightSum += weight;
+            }
+            return weightedSum / weightSum;
+        }
+
+        virtual int sampleCount() const override {return archive.size();}
+
+    private:
+        struct Sample {
+            std::vector<int> integerGenes;
+            std::vector<int> successor;
+            std::vector<double> doubleGenes;
+            double score;
+        };
+
+        GenomeDistance distance;
+        int k;
+        int capacity;
+        int next = 0;
+        std::vector<Sample> archive;
+        std::vector<std::pair<double, int>> distances;
+        std::vector<int> integerScratch;
+        std::vector<double> doubleScratch;
+
+        static std::vector<int> successors(const std::vector<int>& tour) {
+            int maxCity = tour.empty() ? -1 : *std::max_element(tour.begin(), tour.end());
+            std::vector<int> successor(maxCity + 1, -1);
+            for(size_t i = 0; i < tour.size(); i++) successor[tour[i]] = tour[(i + 1) % tour.size()];
+            return successor;
+        }
+
+        double sampleDistance(const Sample& sample, GeneView<const int> integerGenes, GeneView<const double> doubleGenes) const {
+            if(distance == GenomeDistance::Euclidean) {
+                double sum = 0.0;
+                for(size_t i = 0; i < doubleGenes.size() && i < sample.doubleGenes.size(); i++) {
+                    double d = doubleGenes[i] - sample.doubleGenes[i];
+                    sum += d * d;
+                }
+                return std::sqrt(sum);
+            }
+            if(distance == GenomeDistance::Hamming) {
+                int differing = 0;
+                for(size_t i = 0; i < integerGenes.size() && i < sample.integerGenes.size(); i++) {
+                    differing += integerGenes[i] != sample.integerGenes[i];
+                }
+                return differing;
+            }
+            int n = integerGenes.size();
+            int successorSize = sample.successor.size();
+            int missing = 0;
+            for(int i = 0; i < n; i++) {
+                int from = integerGenes[i];
+                int to = integerGenes[(i + 1) % n];
+                bool forward = from < successorSize && sample.successor[from] == to;
+                bool backward = to < successorSize && sample.successor[to] == from;
+                missing += !(forward || backward);
+            }
+            return missing;
+        }
+};
+
+/// @brief Linear surrogate over undirected tour edge features for permutation
+/// (tour) genomes: the predicted score is the sum of a learned weight per
+/// edge, trained online by least mean squares on every evaluated tour. Suits
+/// additive objectives such as tour length, where it can learn the objective
+/// exactly. Unseen edges start at the mean per edge score. Each new sample is
+/// trained on together with a mini-batch of replaySize stored samples, taken
+/// in turn from the archive, so the cost per sample does not grow with capacity
+class EdgeLinearSurrogate : public SurrogateModelBase {
+    public:
+        /// @param learningRate Step size of each least mean squares update
+        /// @param epochs Passes over the new sample and its replay mini-batch
+        /// @param capacity Stored samples replayed while training
+        /// @param replaySize Stored samples replayed per new sample
+        EdgeLinearSurrogate(double learningRate=0.5, int epochs=1, int capacity=256, int replaySize=8)
+        : learningRate(learningRate), epochs(epochs), capacity(capacity), replaySize(replaySize) {}
+
+        virtual void addSample(const RepresentationBase& representation, double score) override {
+            std::vector<int> tour = representation.getIntegerVectorRepresentation();
+            if(tour.empty()) return;
+            samples++;
+            meanEdgeScore += (score / tour.size() - meanEdgeScore) / samples;
+            for(int e = 0; e < epochs; e++) {
+                train(tour, score);
+                for(int r = 0; r < replaySize && !archive.empty(); r++) {
+                    replayNext = (replayNext + 1) % archive.size();
+                    train(archive[replayNext].first, archive[replayNext].second);
+                }
+            }
+            if(static_cast<int>(archive.size()) < capacity) {
+                archive.push_back(std::make_pair(std::move(tour), score));
+            } else {
+                archive[next] = std::make_pair(std::move(tour), score);
+                next = (next + 1) % capacity;
+            }
+        }
+
+        virtual double predict(const RepresentationBase& representation) override {
+            GeneView<const int> tour = readIntegerGenes(representation, scratch);
+            double prediction = 0.0;
+            int n = tour.size();
+            for(int i = 0; i < n; i++) prediction += weight(tour[i], tour[(i + 1) % n]);
+            return prediction;
+        }
+
+        virtual int sampleCount() const override {return samples;}
+
+    private:
+        double learningRate;
+        int epochs;
+        int capacity;
+        int replaySize;
+        int next = 0;
+        size_t replayNext = 0;
+        int samples = 0;
+        double meanEdgeScore = 0.0;
+        std::unordered_map<uint64_t, double> weights;
+        std::vector<std::pair<std::vector<int>, double>> archive;
+        std::vector<int> scratch;
+
+        static uint64_t edgeKey(int a, int b) {
+            if(a > b) std::swap(a, b);
+            return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+        }
+
+        double weight(int a, int b) const {
+            auto it = weights.find(edgeKey(a, b));
+            return it == weights.end() ? meanEdgeScore : it->second;
+        }
+
+        void train(const std::vector<int>& tour, double score) {
+            int n = tour.size();
+            double prediction = 0.0;
+            for(int i = 0; i < n; i++) prediction += weight(tour[i], tour[(i + 1) % n]);
+            //Normalised least mean squares, the error is shared over the n edges
+            double step = learningRate * (score - prediction) / n;
+            for(int i = 0; i < n; i++) {
+                uint64_t key = edgeKey(tour[i], tour[(i + 1) % n]);
+                auto it = weights.find(key);
+                if(it == weights.end()) it = weights.emplace(key, meanEdgeScore).first;
+                it->second += step;
+            }
+        }
+};
+
+/// @brief Pre-screens batches of unevaluated children with a surrogate model
+/// so only the most promising fraction reaches the real objective. Until the
+/// model holds minSamples genomes every candidate is evaluated. Candidates
+/// repeating a genome that has already been evaluated (e.g. a crossover of two
+/// identical parents) are ranked last, their score is known and spending an
+/// evaluation on them only costs diversity. The hashes of the last
+/// knownGenomeCapacity evaluated genomes are remembered. Set on a
+/// Population with Population::setSurrogate(), used by
+/// Population::evaluateAndAddMembers()
+class SurrogateScreen {
+    public:
+        /// @param model Surrogate model to train and predict with
+        /// @param evaluateFraction Fraction of each batch sent to the objective
+        /// @param minSamples Samples required before screening starts
+        /// @param knownGenomeCapacity Evaluated genomes remembered to rank
+        /// repeats last, the oldest are forgotten first
+        SurrogateScreen(std::unique_ptr<SurrogateModelBase> model, double evaluateFraction=0.3, int minSamples=50, int knownGenomeCapacity=65536)
+        : model(std::move(model)), evaluateFraction(evaluateFraction), minSamples(minSamples), knownGenomeCapacity(knownGenomeCapacity) {}
+
+        /// @brief Choose which candidates are worth a real evaluation
+        /// @param candidates Representations of unevaluated children
+        /// @return vector<int> of candidate indices to evaluate, in input order
+        std::vector<int> choose(const std::vector<const RepresentationBase*>& candidates) {
+            int n = candidates.size();
+            std::vector<int> chosen(n);
+            std::iota(chosen.begin(), chosen.end(), 0);
+            candidateCount += n;
+            if(model->sampleCount() < minSamples || n == 0) {
+                evaluatedCount += n;
+                return chosen;
+            }
+            std::vector<double> predictions(n);
+            for(int i = 0; i < n; i++) {
+                bool evaluated = evaluatedGenomes.count(hashGenes(*candidates[i])) > 0;
+                predictions[i] = evaluated ? std::numeric_limits<double>::infinity() : model->predict(*candidates[i]);
+            }
+            int keep = std::max(1, static_cast<int>(std::ceil(evaluateFraction * n)));
+            std::nth_element(chosen.begin(), chosen.begin() + (keep - 1), chosen.end(), [&](int a, int b) {
+                return predictions[a] < predictions[b];
+            });
+            chosen.resize(keep);
+            std::sort(chosen.begin(), chosen.end());
+            evaluatedCount += keep;
+            skippedCount += n - keep;
+            return chosen;
+        }
+
+        /// @brief Train the model on an evaluated genome
+        void observe(const RepresentationBase& representation, double score) {
+            model->addSample(representation, score);
+            std::size_t hash = hashGenes(representation);
+            if(!evaluatedGenomes.insert(hash).second) return;
+            evaluatedOrder.push_back(hash);
+            if(static_cast<int>(evaluatedOrder.size()) > knownGenomeCapacity) {
+                evaluatedGenomes.erase(evaluatedOrder.front());
+                evaluatedOrder.pop_front();
+            }
+        }
+
+        /// @brief Number of children passed to choose()
+        long long getCandidateCount() const {return candidateCount;}
+
+        /// @brief Number of children sent to the real objective
+        long long getEvaluatedCount() const {return evaluatedCount;}
+
+        /// @brief Number of real evaluations saved by discarding children
+        long long getSavedEvaluationCount() const {return skippedCount;}
+
+        SurrogateModelBase& getModel() {return *model;}
+
+    private:
+        std::unique_ptr<SurrogateModelBase> model;
+        double evaluateFraction;
+        int minSamples;
+        int knownGenomeCapacity;
+        long long candidateCount = 0;
+        long long evaluatedCount = 0;
+        long long skippedCount = 0;
+        std::unordered_set<std::size_t> evaluatedGenomes;
+        //Insertion order of evaluatedGenomes, oldest first
+        std::deque<std::size_t> evaluatedOrder;
+};
+#endif
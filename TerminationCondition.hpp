@@ -90,7 +90,11 @@ class FitnessFunctionCallTerminationFlag : public TerminationFlagBase {
             }
             if(objective->getCallCount() >= callCountLimit) {
 
-                if(!this->alreadyPrinted) std::cout << "FitnessFunctionCallTerminationFlag terminating: objective function call count = " << objective->getCallCount() << "\n";
+                if(!this->alreadyPrinted) {
+                    std::cout << "FitnessFunctionCallTerminationFlag terminating: objective function call count = " << objective->getCallCount();
+                    if(objective->getAbortedCallCount() > 0) std::cout << " (aborted at the score bound " << objective->getAbortedCallCount() << ")";
+                    std::cout << "\n";
+                }
                 this->alreadyPrinted = true;
                 return true;
             }
@@ -103,7 +107,11 @@ class FitnessFunctionCallTerminationFlag : public TerminationFlagBase {
 
         virtual double checkProgress() const override {return double(objective->getCallCount()) / callCountLimit;}
 
-        virtual void reportProgress() const override {std::cout << "fitness function calls: " << objective->getCallCount() << " : " << callCountLimit << "\n";}
+        virtual void reportProgress() const override {
+            std::cout << "fitness function calls: " << objective->getCallCount() << " : " << callCountLimit;
+            if(objective->getAbortedCallCount() > 0) std::cout << " (aborted " << objective->getAbortedCallCount() << ")";
+            std::cout << "\n";
+        }
 };
 
 class MinimumPopulationTerminationFlag : public TerminationFlagBase {
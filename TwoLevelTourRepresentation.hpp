@@ -0,0 +1,267 @@
+#ifndef TWOLEVELTOURREPRESENTATION_HPP
+#define TWOLEVELTOURREPRESENTATION_HPP
+#include <vector>
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include "Representation.hpp"
+
+/// @brief Tour representation stored as a two-level list: the tour is split
+/// into roughly sqrt(n) segments, each carrying a reversal bit. A 2-opt
+/// reversal only splits the two end segments and flips the order / reversal
+/// bits of the segments in between, so next / prev / between / reverse all
+/// cost O(sqrt(n)) rather than O(n). The flat permutation is only rebuilt when
+/// getIntegerVectorRepresentation() is called.
+class TwoLevelTourRepresentation : public RepresentationBase {
+    public:
+        TwoLevelTourRepresentation() {}
+
+        TwoLevelTourRepresentation(const std::vector<int>& tour) {
+            build(tour);
+        }
+
+        virtual std::string toString() const override {
+            std::stringstream ss;
+            for(int city : getIntegerVectorRepresentation()) {
+                ss << city << ",";
+            }
+            return ss.str();
+        }
+
+        virtual int size() const override {return numCities;}
+
+        virtual std::unique_ptr<RepresentationBase> emptyCopy() const override {
+            return std::make_unique<TwoLevelTourRepresentation>();
+        }
+
+        virtual std::unique_ptr<RepresentationBase> deepCopy() const override {
+            return std::make_unique<TwoLevelTourRepresentation>(*this);
+        }
+
+        /// @brief Flattens the tour into a permutation, the flat copy is cached
+        /// until the next reversal
+        /// @return vector<int> of cities in tour order
+        virtual std::vector<int> getIntegerVectorRepresentation() const override {
+            if(flatDirty) {
+                flatten(flatCache);
+                flatDirty = false;
+            }
+            return flatCache;
+        }
+
+        virtual void setIntegerVectorRepresentation(std::vector<int>& rep) override {
+            build(rep);
+        }
+
+        /// @brief View of the cached flat permutation, rebuilt first if a
+        /// reversal has happened since. No mutable view is given, writes would
+        /// bypass the segment list
+        virtual GeneView<const int> getIntegerGenes() const override {
+            if(flatDirty) {
+                flatten(flatCache);
+                flatDirty = false;
+            }
+            return GeneView<const int>(flatCache.data(), flatCache.size());
+        }
+
+        /// @brief City following city in tour order
+        /// @param city City to query
+        /// @return int successor of city
+        int next(int city) const {
+            int s = segmentOf[city];
+            int i = orientedIndex(city);
+            if(i + 1 < segmentLength(s)) return cityAtOriented(s, i + 1);
+            int nextSegment = order[(segments[s].rank + 1) % order.size()];
+            return cityAtOriented(nextSegment, 0);
+        }
+
+        /// @brief City preceding city in tour order
+        /// @param city City to query
+        /// @return int predecessor of city
+        int prev(int city) const {
+            int s = segmentOf[city];
+            int i = orientedIndex(city);
+            if(i > 0) return cityAtOriented(s, i - 1);
+            int prevSegment = order[(segments[s].rank + order.size() - 1) % order.size()];
+            return cityAtOriented(prevSegment, segmentLength(prevSegment) - 1);
+        }
+
+        /// @brief Checks whether b lies on the forward path from a to c
+        /// (inclusive of both ends)
+        /// @return true if b is between a and c
+        bool between(int a, int b, int c) const {
+            long long ka = key(a), kb = key(b), kc = key(c);
+            if(ka <= kc) return ka <= kb && kb <= kc;
+            return kb >= ka || kb <= kc;
+        }
+
+        /// @brief Gets the city at a position of the flattened tour without
+        /// flattening it
+        /// @param position Index into the flat permutation
+        /// @return int city at position
+        int cityAt(int position) const {
+            for(int s : order) {
+                int length = segmentLength(s);
+                if(position < length) return cityAtOriented(s, position);
+                position -= length;
+            }
+            std::cerr << "TwoLevelTourRepresentation::cityAt\nPosition out of range\nExiting Program\n";
+            exit(-1);
+        }
+
+        /// @brief Reverses the path running forwards from city a to city b.
+        /// If that path wraps past the start of the tour the complementary path
+        /// is reversed instead, which gives the same cycle in the opposite
+        /// direction
+        /// @param a First city of path to reverse
+        /// @param b Last city of path to reverse
+        void reverse(int a, int b) {
+            if(a == b) return;
+            splitBefore(a);
+            splitAfter(b);
+            int ra = segments[segmentOf[a]].rank;
+            int rb = segments[segmentOf[b]].rank;
+            if(ra <= rb) {
+                reverseSegmentRun(ra, rb);
+            } else if(rb + 1 <= ra - 1) {
+                reverseSegmentRun(rb + 1, ra - 1);
+            }
+            flatDirty = true;
+            if(static_cast<int>(order.size()) > 2 * targetSegmentCount) rebuild();
+        }
+
+    private:
+        struct Segment {
+            std::vector<int> cities;
+            bool reversed = false;
+            int rank = 0;
+        };
+
+        std::vector<Segment> segments;
+        std::vector<int> order;
+        std::vector<int> segmentOf;
+        std::vector<int> offsetOf;
+        int numCities = 0;
+        int targetSegmentCount = 1;
+        mutable std::vector<int> flatCache;
+        mutable bool flatDirty = true;
+
+        void build(const std::vector<int>& tour) {
+            //segmentOf and offsetOf are indexed by city
+            std::vector<char> seen(tour.size(), 0);
+            for(int city : tour) {
+                if(city < 0 || city >= static_cast<int>(tour.size()) || seen[city]) {
+                    std::cerr << "TwoLevelTourRepresentation\nTour must hold each city 0.." << static_cast<int>(tour.size()) - 1 << " exactly once, got " << city << "\nExiting Program\n";
+                    exit(-1);
+                }
+                seen[city] = 1;
+            }
+            numCities = tour.size();
+            int segmentSize = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(numCities))));
+            targetSegmentCount = std::max(1, (numCities + segmentSize - 1) / segmentSize);
+            segments.clear();
+            order.clear();
+            segmentOf.assign(numCities, 0);
+            offsetOf.assign(numCities, 0);
+            for(int start = 0; start < numCities; start += segmentSize) {
+                Segment segment;
+                segment.rank = segments.size();
+                int end = std::min(numCities, start + segmentSize);
+                segment.cities.assign(tour.begin() + start, tour.begin() + end);
+                for(int i = 0; i < end - start; i++) {
+                    segmentOf[segment.cities[i]] = segments.size();
+                    offsetOf[segment.cities[i]] = i;
+                }
+                order.push_back(segments.size());
+                segments.push_back(std::move(segment));
+            }
+            flatCache = tour;
+            flatDirty = false;
+        }
+
+        void rebuild() {
+            std::vector<int> tour;
+            flatten(tour);
+            build(tour);
+        }
+
+        void flatten(std::vector<int>& tour) const {
+            tour.resize(numCities);
+            int position = 0;
+            for(int s : order) {
+                int length = segmentLength(s);
+                for(int i = 0; i < length; i++) {
+                    tour[position++] = cityAtOriented(s, i);
+                }
+            }
+        }
+
+        int segmentLength(int s) const {return segments[s].cities.size();}
+
+        int orientedIndex(int city) const {
+            const Segment& segment = segments[segmentOf[city]];
+            return segment.reversed ? segment.cities.size() - 1 - offsetOf[city] : offsetOf[city];
+        }
+
+        int cityAtOriented(int s, int i) const {
+            const Segment& segment = segments[s];
+            return segment.reversed ? segment.cities[segment.cities.size() - 1 - i] : segment.cities[i];
+        }
+
+        long long key(int city) const {
+            return static_cast<long long>(segments[segmentOf[city]].rank) * (numCities + 1) + orientedIndex(city);
+        }
+
+        /// @brief Splits segment s so that oriented positions [i, length) move
+        /// to a new segment placed directly after s, requires 0 < i < length
+        void split(int s, int i) {
+            Segment newSegment;
+            newSegment.reversed = segments[s].reversed;
+            std::vector<int>& cities = segments[s].cities;
+            int length = cities.size();
+            if(!segments[s].reversed) {
+                newSegment.cities.assign(cities.begin() + i, cities.end());
+                cities.resize(i);
+            } else {
+                newSegment.cities.assign(cities.begin(), cities.begin() + (length - i));
+                cities.erase(cities.begin(), cities.begin() + (length - i));
+                for(int k = 0; k < static_cast<int>(cities.size()); k++) {
+                    offsetOf[cities[k]] = k;
+                }
+            }
+            int t = segments.size();
+            for(int k = 0; k < static_cast<int>(newSegment.cities.size()); k++) {
+                segmentOf[newSegment.cities[k]] = t;
+                offsetOf[newSegment.cities[k]] = k;
+            }
+            int rank = segments[s].rank;
+            segments.push_back(std::move(newSegment));
+            order.insert(order.begin() + rank + 1, t);
+            for(int r = rank + 1; r < static_cast<int>(order.size()); r++) {
+                segments[order[r]].rank = r;
+            }
+        }
+
+        void splitBefore(int city) {
+            int i = orientedIndex(city);
+            if(i > 0) split(segmentOf[city], i);
+        }
+
+        void splitAfter(int city) {
+            int i = orientedIndex(city);
+            if(i + 1 < segmentLength(segmentOf[city])) split(segmentOf[city], i + 1);
+        }
+
+        void reverseSegmentRun(int first, int last) {
+            std::reverse(order.begin() + first, order.begin() + last + 1);
+            for(int r = first; r <= last; r++) {
+                Segment& segment = segments[order[r]];
+                segment.reversed = !segment.reversed;
+                segment.rank = r;
+            }
+        }
+};
+#endif
@@ -1,6 +1,7 @@
 #ifndef PHENOTYPE_HPP
 #define PHENOTYPE_HPP
 #include <memory>
+#include <vector>
 #include <iostream>
 #include <iomanip>
 #include "Representation.hpp"
@@ -29,6 +30,7 @@ class PhenotypeBase {
         /// @param b Const reference to object to copy
         PhenotypeBase(const PhenotypeBase& b) {
             this->score = b.score;
+            this->objectiveValues = b.objectiveValues;
             this->representation = b.representation->deepCopy();
         }
 
@@ -41,6 +43,15 @@ class PhenotypeBase {
         /// @return double score
         virtual double getScore() const {return score;};
 
+        /// @brief Getter for the per objective values set by a
+        /// MultiObjectiveBase, empty for single objective problems
+        /// @return const reference to objective values
+        const std::vector<double>& getObjectiveValues() const {return objectiveValues;}
+
+        /// @brief Setter for the per objective values
+        /// @param values One value per objective, all minimised
+        void setObjectiveValues(const std::vector<double>& values) {objectiveValues = values;}
+
         /// @brief Getter for the size of phenotype representation
         /// @return int: size of phenotype representation
         virtual int getRepresentationSize() const {return representation->size();};
@@ -49,6 +60,23 @@ class PhenotypeBase {
         /// @return Const reference to phenotype representation
         const RepresentationBase& getRepresentation() const {return *representation;}
 
+        /// @brief Getter for modifying the representation in place, the score
+        /// is stale until reevaluate() is called
+        /// @return Reference to phenotype representation
+        RepresentationBase& getMutableRepresentation() {return *representation;}
+
+        /// @brief Score the current representation again, after it has been
+        /// modified in place through getMutableRepresentation()
+        /// @param objective Objective class which will be used to evaluate the phenotype
+        void reevaluate(const std::unique_ptr<ObjectiveBase>& objective) {
+            if(!objective) {
+                std::cerr << "In void reevaluate(const std::unique_ptr<ObjectiveBase>& objective)\n";
+                std::cerr << "Could not evaluate because objective pointer is nullptr\nExiting program\n";
+                exit(0);
+            }
+            score = objective->evaluate(*this);
+        }
+
         //Operator overloads
         /// @brief Implementation of lesser operator for PhenotypeBase<T>
         /// @param b const reference to other operand
@@ -83,10 +111,12 @@ class PhenotypeBase {
         /// @param newRepresentation New representation to set, must be same size as
         /// original representation
         /// @param objective Objective class which will be used to evaluate the phenotype
-        void setRepresentation(std::unique_ptr<RepresentationBase> newRepresentation, const std::unique_ptr<ObjectiveBase>& objective) {
+        /// @param bounded Evaluate under the objective's score bound, for new
+        /// children only, see ObjectiveBase::setScoreBound()
+        void setRepresentation(std::unique_ptr<RepresentationBase> newRepresentation, const std::unique_ptr<ObjectiveBase>& objective, bool bounded=false) {
             representation = std::move(newRepresentation);
             if(objective) {
-                score = objective->evaluate(*this);
+                score = objective->evaluate(*this, bounded);
             } else {
                 std::cerr << "In void setRepresentation(std::unique_ptr<RepresentationBase> newRepresentation, std::unique_ptr<Objective<T>>& objective)\n";
                 std::cerr << "Could not change representation because objective pointer is nullptr\n";
@@ -100,5 +130,6 @@ class PhenotypeBase {
             std::unique_ptr<RepresentationBase> representation;
             ObjectiveBase* tempObj;
             double score;
+            std::vector<double> objectiveValues;
 };
 #endif
\ No newline at end of file
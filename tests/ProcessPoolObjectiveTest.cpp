@@ -0,0 +1,58 @@
+//Checks that ProcessPoolObjective finishes a batch when its only worker dies
+//before reading a genome, so the parent's write fails: the genomes are
+//re-sent to the restarted worker until they run out of retries.
+//Build from the repository root with
+//g++ -std=c++17 -O2 -pthread -I. tests/ProcessPoolObjectiveTest.cpp -o ProcessPoolObjectiveTest
+#include <random>
+#include <numeric>
+#include <unordered_set>
+#include <cmath>
+#include <iomanip>
+#include <cassert>
+#include <unistd.h>
+#include "phenotype.hpp"
+#include "IntegerVectorRepresentation.hpp"
+#include "ProcessPoolObjective.hpp"
+
+class VectorPhenotype : public PhenotypeBase {
+    public:
+        std::shared_ptr<PhenotypeBase> emptyCopy() const override {return std::make_shared<VectorPhenotype>();}
+        std::shared_ptr<PhenotypeBase> deepCopy() const override {return std::make_shared<VectorPhenotype>(*this);}
+        const bool operator==(PhenotypeBase const& b) const override {
+            return getRepresentation().getIntegerVectorRepresentation() == b.getRepresentation().getIntegerVectorRepresentation();
+        }
+};
+
+class GeneSum : public ObjectiveBase {
+    public:
+        double fitnessFunction(PhenotypeBase& phenotype) override {
+            std::vector<int> genes = phenotype.getRepresentation().getIntegerVectorRepresentation();
+            return std::accumulate(genes.begin(), genes.end(), 0.0);
+        }
+};
+
+int main() {
+    //Larger than a socket buffer, so sending to a dead worker fails
+    const int genomeLength = 1 << 22;
+    const double failureScore = 12345.0;
+    ProcessPoolObjective pool([]() -> std::unique_ptr<ObjectiveBase> {
+        _exit(1);
+    }, std::make_shared<VectorPhenotype>(), std::make_unique<IntegerVectorRepresentation>(), 1);
+    pool.setMaxRetries(2);
+    pool.setFailureScore(failureScore);
+
+    std::vector<std::shared_ptr<PhenotypeBase>> phenotypes;
+    std::vector<PhenotypeBase*> pointers;
+    for(int i = 0; i < 3; i++) {
+        std::vector<int> genes(genomeLength, 1);
+        phenotypes.push_back(std::make_shared<VectorPhenotype>());
+        phenotypes.back()->setRepresentation_NOEVALUATE(std::make_unique<IntegerVectorRepresentation>(genes));
+        pointers.push_back(phenotypes.back().get());
+    }
+    std::vector<double> scores = pool.evaluateBatch(pointers);
+
+    for(double score : scores) assert(score == failureScore);
+    assert(pool.getCrashCount() > 0);
+    std::cout << "ProcessPoolObjectiveTest passed, " << pool.getCrashCount() << " worker crashes\n";
+    return 0;
+}
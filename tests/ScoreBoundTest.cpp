@@ -0,0 +1,123 @@
+//Checks that evaluating children under the score bound only skips work: a run
+//whose objective aborts tours longer than ObjectiveBase::getScoreBound() keeps
+//exactly the survivors of the same run evaluated in full, also when survivors
+//are re-scored in place by mutation or replaced by a StagnationMonitor.
+//Build from the repository root with
+//g++ -std=c++17 -O2 -pthread -I. tests/ScoreBoundTest.cpp -o ScoreBoundTest
+#include <random>
+#include <numeric>
+#include <unordered_set>
+#include <cmath>
+#include <iomanip>
+#include <cassert>
+#include "phenotype.hpp"
+#include "IntegerVectorRepresentation.hpp"
+#include "Initialisation.hpp"
+#include "GeneticAlgorithm.hpp"
+#include "Selection.hpp"
+#include "Crossover.hpp"
+#include "Mutation.hpp"
+#include "Reproduction.hpp"
+
+class TourPhenotype : public PhenotypeBase {
+    public:
+        std::shared_ptr<PhenotypeBase> emptyCopy() const override {return std::make_shared<TourPhenotype>();}
+        std::shared_ptr<PhenotypeBase> deepCopy() const override {return std::make_shared<TourPhenotype>(*this);}
+        const bool operator==(PhenotypeBase const& b) const override {
+            return getRepresentation().getIntegerVectorRepresentation() == b.getRepresentation().getIntegerVectorRepresentation();
+        }
+};
+
+/// @brief Tour length, optionally abandoned once it exceeds the score bound
+class TourLength : public ObjectiveBase {
+    public:
+        TourLength(std::shared_ptr<const Initialisation::TourInstance> instance, bool bounded) : instance(instance), bounded(bounded) {}
+
+        double fitnessFunction(PhenotypeBase& phenotype) override {
+            GeneView<const int> tour = phenotype.getRepresentation().getIntegerGenes();
+            int n = tour.size();
+            double bound = getScoreBound();
+            double length = 0.0;
+            for(int i = 0; i < n; i++) {
+                length += instance->distance(tour[i], tour[(i + 1) % n]);
+                if(bounded && length > bound) return rejectedScore;
+            }
+            return length;
+        }
+
+    private:
+        std::shared_ptr<const Initialisation::TourInstance> instance;
+        bool bounded;
+};
+
+class TourGeneticAlgorithm : public GeneticAlgorithm {
+    public:
+        using GeneticAlgorithm::GeneticAlgorithm;
+
+        std::vector<std::pair<double, std::vector<int>>> survivors() {
+            std::vector<std::pair<double, std::vector<int>>> members;
+            for(int i = 0; i < population->size(); i++) {
+                members.emplace_back((*population)[i].getScore(), (*population)[i].getRepresentation().getIntegerVectorRepresentation());
+            }
+            std::sort(members.begin(), members.end());
+            return members;
+        }
+
+        int abortedCalls() const {return objective->getAbortedCallCount();}
+
+    protected:
+        void geneticAlgorithm() override {
+            population->clearSelected();
+            Selection::binaryTournamentSelection(*population, population->size(), terminationManager);
+            //Survivors re-scored in place, usually worse, before children are bred
+            Variation::twoOptSwap(*population, terminationManager, 0.5);
+            Variation::orderedCrossover(*population, terminationManager, 0.9);
+            Variation::rotationToRight(*population, terminationManager, 0.2);
+            Reproduction::nElitism(*population, populationSize, terminationManager);
+        }
+
+    private:
+        static constexpr int populationSize = 60;
+};
+
+int main() {
+    int n = 200;
+    std::mt19937 cityEngine(5);
+    std::uniform_real_distribution<double> coordinate(0.0, 1000.0);
+    std::vector<double> x(n), y(n);
+    for(int i = 0; i < n; i++) {
+        x[i] = coordinate(cityEngine);
+        y[i] = coordinate(cityEngine);
+    }
+    std::shared_ptr<const Initialisation::TourInstance> instance = std::make_shared<const Initialisation::TourInstance>(x, y, 10);
+
+    for(int monitored = 0; monitored < 2; monitored++) {
+        std::vector<std::pair<double, std::vector<int>>> results[2];
+        int abortedCalls[2];
+        int replacedCount = 0;
+        for(int bounded = 0; bounded < 2; bounded++) {
+            RandomStream::seed(11);
+            IntegerVectorRepresentation prototype;
+            std::vector<std::unique_ptr<RepresentationBase>> representations = Initialisation::generateTours(prototype, 60, n, {{Initialisation::randomTour(), 1.0}}, 1, 9);
+            TourGeneticAlgorithm algorithm(std::make_shared<TourPhenotype>(), std::move(representations), std::make_unique<TourLength>(instance, bounded));
+            if(monitored) {
+                algorithm.setStagnationMonitor(std::make_unique<StagnationMonitor>(5, 0.05, 0.0, StagnationMonitor::RecoveryAction::PartialReseed, 5, 0.5));
+            }
+            //A flag firing mid-generation would skip the last truncation, the
+            //call budget of runUntil() stops between generations instead
+            algorithm.addTerminationFlag(std::make_unique<FitnessFunctionCallTerminationFlag>(1 << 30));
+            algorithm.runUntil(20000);
+            results[bounded] = algorithm.survivors();
+            abortedCalls[bounded] = algorithm.abortedCalls();
+            if(monitored) replacedCount = algorithm.getStagnationMonitor()->getReplacedCount();
+        }
+
+        assert(abortedCalls[0] == 0);
+        assert(abortedCalls[1] > 0);
+        assert(!monitored || replacedCount > 0);
+        assert(results[0] == results[1]);
+        std::cout << "ScoreBoundTest " << (monitored ? "with" : "without") << " stagnation monitor passed, "
+                  << abortedCalls[1] << " bounded evaluations aborted, " << replacedCount << " members reseeded\n";
+    }
+    return 0;
+}